@@ -18,12 +18,79 @@
 
 #include "data-entity.h"
 
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
 using namespace LingmoMenu;
 
-class DataEntityPrivate
+// 常量池最多保存的字符串数量，超过后新的值不再共享，避免常量池无限增长
+#define INTERN_POOL_MAX_SIZE 512
+
+/**
+ * 字符串常量池
+ * 只用于分类和分组这类取值很少的属性，相同的值只保留一份数据，其余实例通过隐式共享引用它
+ */
+static QString internString(const QString &value)
+{
+    if (value.isEmpty()) {
+        return {};
+    }
+
+    static QMutex mutex;
+    static QSet<QString> pool;
+
+    QMutexLocker locker(&mutex);
+    auto it = pool.constFind(value);
+    if (it != pool.constEnd()) {
+        return *it;
+    }
+
+    if (pool.size() < INTERN_POOL_MAX_SIZE) {
+        pool.insert(value);
+    }
+    return value;
+}
+
+/**
+ * 解析 yyyy-MM-dd hh:mm:ss 格式的本地时间
+ * 格式固定，逐字符解析比QDateTime::fromString快得多
+ * @return 秒级时间戳，格式错误时返回0
+ */
+static qint64 parseInsertTime(const QString &insertTime)
+{
+    if (insertTime.size() != 19) {
+        return 0;
+    }
+
+    const QChar *data = insertTime.constData();
+    auto number = [data] (int pos, int length, int &value) -> bool {
+        value = 0;
+        for (int i = pos; i < pos + length; ++i) {
+            if (!data[i].isDigit()) {
+                return false;
+            }
+            value = value * 10 + data[i].digitValue();
+        }
+        return true;
+    };
+
+    int year, month, day, hour, minute, second;
+    if (!number(0, 4, year) || !number(5, 2, month) || !number(8, 2, day)
+        || !number(11, 2, hour) || !number(14, 2, minute) || !number(17, 2, second)) {
+        return 0;
+    }
+
+    QDateTime dateTime(QDate(year, month, day), QTime(hour, minute, second));
+    return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : 0;
+}
+
+class DataEntityPrivate : public QSharedData
 {
 public:
     DataEntityPrivate() = default;
+    DataEntityPrivate(const DataEntityPrivate &other) = default;
     DataEntityPrivate(DataType::Type type, QString name, QString icon, QString comment, QString extraData)
         : type(type), name(std::move(name)), icon(std::move(icon)), comment(std::move(comment)), extraData(std::move(extraData)) {}
 
@@ -33,6 +100,7 @@ public:
     int top{0};             // 置顶状态及序号
     int favorite{0};        // 收藏状态及序号
     int launchTimes{0};     // 启动次数
+    qint64 installTime{0};  // 安装时间戳
     double priority{0};
     DataType::Type type {DataType::Normal};
     QString id;             // 应用可执行文件路径
@@ -132,6 +200,12 @@ QString DataEntity::insertTime() const
 void DataEntity::setInsertTime(const QString &insertTime)
 {
     d->insertTime = insertTime;
+    d->installTime = parseInsertTime(insertTime);
+}
+
+qint64 DataEntity::installTime() const
+{
+    return d->installTime;
 }
 
 QString DataEntity::id() const
@@ -146,7 +220,7 @@ void DataEntity::setId(const QString &id)
 
 void DataEntity::setCategory(const QString &category)
 {
-    d->category = category;
+    d->category = internString(category);
 }
 
 QString DataEntity::category() const
@@ -234,40 +308,29 @@ QHash<int, QByteArray> DataEntity::AppRoleNames()
     names.insert(DataEntity::Top, "top");
     names.insert(DataEntity::RecentInstall, "recentInstall");
     names.insert(DataEntity::Entity, "entity");
+    names.insert(DataEntity::InstallTimestamp, "installTimestamp");
     return names;
 }
 
-DataEntity::DataEntity(const DataEntity &other) : d(new DataEntityPrivate)
-{
-    *d = *(other.d);
-}
+// 拷贝只增加引用计数，在调用set方法时才会分离数据
+DataEntity::DataEntity(const DataEntity &other) = default;
 
-DataEntity& DataEntity::operator=(const DataEntity &other)
-{
-    if (this != &other) {
-        *d = *(other.d);
-    }
-    return *this;
-}
+DataEntity& DataEntity::operator=(const DataEntity &other) = default;
 
-DataEntity::DataEntity(DataEntity &&other) noexcept : d(new DataEntityPrivate)
+// 被移动的对象仍需保持可用，所以此处共享数据而不是置空
+DataEntity::DataEntity(DataEntity &&other) noexcept : d(other.d)
 {
-    *d = *(other.d);
+
 }
 
+// 与移动构造一样，被移动的对象仍需保持可用，所以此处交换数据，other持有原来的数据
 DataEntity &DataEntity::operator=(DataEntity &&other) noexcept
 {
-    *d = *(other.d);
+    d.swap(other.d);
     return *this;
 }
 
-DataEntity::~DataEntity()
-{
-    if (d) {
-        delete d;
-        d = nullptr;
-    }
-}
+DataEntity::~DataEntity() = default;
 
 QVariant DataEntity::getValue(DataEntity::PropertyName property) const
 {
@@ -306,6 +369,8 @@ QVariant DataEntity::getValue(DataEntity::PropertyName property) const
             return d->recentInstall;
         case Entity:
             return QVariant::fromValue(*this);
+        case InstallTimestamp:
+            return d->installTime;
         default:
             break;
     }
@@ -335,16 +400,17 @@ void DataEntity::setValue(DataEntity::PropertyName property, const QVariant &val
             d->extraData = value.toString();
             break;
         case Category:
-            d->category = value.toString();
+            d->category = internString(value.toString());
             break;
         case Group:
-            d->group = value.toString();
+            d->group = internString(value.toString());
             break;
         case FirstLetter:
             d->firstLetter = value.toString();
             break;
         case InstallationTime:
             d->insertTime = value.toString();
+            d->installTime = parseInsertTime(d->insertTime);
             break;
         case IsLaunched:
             d->launched = value.toBool();
@@ -364,6 +430,9 @@ void DataEntity::setValue(DataEntity::PropertyName property, const QVariant &val
         case RecentInstall:
             d->recentInstall = value.toBool();
             break;
+        case InstallTimestamp:
+            d->installTime = value.toLongLong();
+            break;
         default:
             break;
     }
@@ -371,7 +440,7 @@ void DataEntity::setValue(DataEntity::PropertyName property, const QVariant &val
 
 void DataEntity::setGroup(const QString &group)
 {
-    d->group = group;
+    d->group = internString(group);
 }
 
 QString DataEntity::group() const
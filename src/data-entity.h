@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QHash>
 #include <QVariant>
+#include <QSharedDataPointer>
 
 class DataEntityPrivate;
 
@@ -40,7 +41,7 @@ public:
     Q_ENUM(Type);
 };
 
-// 应用数据
+// 应用数据，隐式共享，修改时才进行深拷贝
 class DataEntity
 {
     Q_GADGET
@@ -69,7 +70,8 @@ public:
         Favorite,         /**> 是否被收藏及序号, 小于或等于0表示未被收藏 */
         Top,              /**> 是否被置顶及序号, 小于或等于0表示未被置顶 */
         RecentInstall,
-        Entity            /**> 返回自己的拷贝 */
+        Entity,           /**> 返回自己的拷贝 */
+        InstallTimestamp  /**> 安装时间的秒级时间戳，由InstallationTime解析得到，无效时为0 */
     };
     DataEntity();
     DataEntity(DataType::Type type, const QString& name, const QString& icon, const QString& comment, const QString& extraData);
@@ -108,6 +110,12 @@ public:
     QString insertTime() const;
     void setInsertTime(const QString& insertTime);
 
+    /**
+     * 安装时间的秒级时间戳，在设置insertTime时解析
+     * @return 时间无效时返回0
+     */
+    qint64 installTime() const;
+
     QString id() const;
     void setId(const QString& id);
 
@@ -136,7 +144,7 @@ public:
     QString group() const;
 
 private:
-    DataEntityPrivate *d {nullptr};
+    QSharedDataPointer<DataEntityPrivate> d;
 };
 
 } // LingmoMenu
@@ -39,6 +39,7 @@ AppFavoritesModel::AppFavoritesModel(QObject *parent) : QAbstractListModel(paren
     updateData();
 
     connect(m_sourceModel, &BasicAppModel::dataChanged, this, &AppFavoritesModel::onAppUpdated);
+    connect(m_sourceModel, &BasicAppModel::rowsInserted, this, &AppFavoritesModel::onAppAdded);
     connect(m_sourceModel, &BasicAppModel::rowsAboutToBeRemoved, this, &AppFavoritesModel::onAppRemoved);
     connect(FavoriteFolderHelper::instance(), &FavoriteFolderHelper::folderAdded, this,&AppFavoritesModel::onFolderAdded);
     connect(FavoriteFolderHelper::instance(), &FavoriteFolderHelper::folderToBeDeleted, this, &AppFavoritesModel::onFolderDeleted);
@@ -91,21 +92,17 @@ void AppFavoritesModel::getFavoritesApps()
 
 void AppFavoritesModel::onAppUpdated(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
-    // 更新全部信息
-    if (roles.isEmpty()) {
-        QPersistentModelIndex topLeftIndex(topLeft);
-        QPersistentModelIndex bottomRightIndex(bottomRight);
-
-        int leftIndex = m_favoritesApps.indexOf(topLeftIndex);
-        int rightIndex = m_favoritesApps.indexOf(topLeftIndex);
+    // roles为空时表示更新全部信息，收藏状态也可能发生了变化
+    bool favoriteChanged = roles.isEmpty() || roles.contains(DataEntity::Favorite);
+    for (int row = topLeft.row(); row <= bottomRight.row(); row ++) {
+        QModelIndex sourceIndex = m_sourceModel->index(row, 0, QModelIndex());
+        if (favoriteChanged) {
+            updateFavoritesApps(m_sourceModel->appOfIndex(row), sourceIndex);
+        }
 
-        Q_EMIT dataChanged(index(leftIndex, 0, QModelIndex()), index(rightIndex, 0, QModelIndex()));
-        // 更新某一项信息
-    } else {
-        for (int row = topLeft.row(); row <= bottomRight.row(); row ++) {
-            if (roles.contains(DataEntity::Favorite) ) {
-                updateFavoritesApps(m_sourceModel->appOfIndex(row), m_sourceModel->index(row, 0, QModelIndex()));
-            }
+        int favoriteIndex = m_favoritesApps.indexOf(QPersistentModelIndex(sourceIndex));
+        if (favoriteIndex >= 0) {
+            Q_EMIT dataChanged(index(favoriteIndex, 0, QModelIndex()), index(favoriteIndex, 0, QModelIndex()), roles);
         }
     }
 }
@@ -230,6 +227,14 @@ bool AppFavoritesModel::isAppIncluded(const QString &appid)
     return m_favoritesApps.contains(index);
 }
 
+void AppFavoritesModel::onAppAdded(const QModelIndex &parent, int first, int last)
+{
+    // 应用数据是异步加载的，新插入的应用中可能包含已收藏的应用
+    for (int row = first; row <= last; ++row) {
+        updateFavoritesApps(m_sourceModel->appOfIndex(row), m_sourceModel->index(row, 0, parent));
+    }
+}
+
 void AppFavoritesModel::onAppRemoved(const QModelIndex &parent, int first, int last)
 {
     for(int row = first; row <= last; ++row) {
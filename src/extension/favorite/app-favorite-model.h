@@ -54,6 +54,7 @@ private:
 
     void addFavoriteApp(const QPersistentModelIndex &modelIndex);
     void removeFavoriteApp(const QPersistentModelIndex &modelIndex);
+    void onAppAdded(const QModelIndex &parent, int first, int last);
     void onAppRemoved(const QModelIndex &parent, int first, int last);
     void onAppUpdated(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles = QVector<int>());
     void updateFavoritesApps(const DataEntity &app, const QModelIndex &sourceIndex);
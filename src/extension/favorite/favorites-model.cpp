@@ -33,7 +33,21 @@ FavoritesModel &FavoritesModel::instance()
 
 FavoritesModel::FavoritesModel(QObject *parent) : QSortFilterProxyModel(parent)
 {
-    connect(&FavoritesConfig::instance(), &FavoritesConfig::configChanged, this, &FavoritesModel::invalidate);
+    connect(&FavoritesConfig::instance(), &FavoritesConfig::configChanged, this, [this] {
+        if (BasicAppModel::instance()->isInBatch()) {
+            m_configChangePending = true;
+            return;
+        }
+        invalidate();
+    });
+
+    // 只有批量修改期间收藏顺序发生变化时才在提交时重新排序，动态排序保持不变
+    connect(BasicAppModel::instance(), &BasicAppModel::batchCommitted, this, [this] {
+        if (m_configChangePending) {
+            m_configChangePending = false;
+            invalidate();
+        }
+    });
 }
 
 bool FavoritesModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
@@ -114,18 +128,21 @@ void FavoritesModel::addAppsToNewFolder(const QString &idFrom, const QString &id
     }
 
     if (AppFavoritesModel::instance().isAppIncluded(idFrom) && AppFavoritesModel::instance().isAppIncluded(idTo)) {
+        BasicAppModel::instance()->beginBatch();
         FavoriteFolderHelper::instance()->addAppsToNewFolder(idFrom, idTo, "");
+        BasicAppModel::instance()->commitBatch();
     }
 }
 
 void FavoritesModel::addAppToFolder(const QString &appId, const QString &folderId)
 {
+    BasicAppModel::instance()->beginBatch();
     if (folderId == "") {
         FavoriteFolderHelper::instance()->addAppToNewFolder(appId, "");
-        return;
+    } else {
+        FavoriteFolderHelper::instance()->addAppToFolder(appId, folderId.toInt());
     }
-
-    FavoriteFolderHelper::instance()->addAppToFolder(appId, folderId.toInt());
+    BasicAppModel::instance()->commitBatch();
 }
 
 void FavoritesModel::addFileToFavorites(const QString &url)
@@ -135,6 +152,8 @@ void FavoritesModel::addFileToFavorites(const QString &url)
 
 void FavoritesModel::clearFavorites()
 {
+    BasicAppModel::instance()->beginBatch();
     AppFavoritesModel::instance().clearFavorites();
+    BasicAppModel::instance()->commitBatch();
 }
 } // LingmoMenu
@@ -78,6 +78,10 @@ private:
     explicit FavoritesModel(QObject *parent = nullptr);
 
     QString urlFromModelIndex(const QModelIndex &modelIndex) const;
+
+private:
+    // 批量修改期间配置发生了变化，提交时需要重新排序
+    bool m_configChangePending {false};
 };
 
 } // LingmoMenu
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "app-catalog-cache.h"
+
+#include <QDir>
+#include <QStandardPaths>
+#include <QFile>
+#include <QSaveFile>
+#include <QLocale>
+#include <QDataStream>
+#include <QDebug>
+
+#define APP_CATALOG_CACHE_PATH "/lingmo-menu/"
+#define APP_CATALOG_CACHE_FILE "app-catalog.cache"
+#define APP_CATALOG_MAGIC 0x43414d4c   // "LMAC"
+// 修改快照格式时需要增加版本号
+#define APP_CATALOG_VERSION 1
+
+namespace LingmoMenu {
+
+enum AppCatalogFlag {
+    Locked   = 0x01,
+    Launched = 0x02
+};
+
+struct AppCatalogHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    quint32 payloadSize;
+    quint16 checksum;
+    quint16 reserved;
+    char locale[16];      // 生成快照时的语言环境，切换语言后快照失效
+};
+
+static QByteArray currentLocale()
+{
+    return QLocale::system().name().toLatin1().left(sizeof(AppCatalogHeader::locale) - 1);
+}
+
+/**
+ * 快照位于 $XDG_CACHE_HOME/lingmo-menu/ 下
+ */
+QString AppCatalogCache::cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + APP_CATALOG_CACHE_PATH;
+}
+
+QString AppCatalogCache::cacheFile()
+{
+    return cacheDir() + APP_CATALOG_CACHE_FILE;
+}
+
+bool AppCatalogCache::load(DataEntityVector &apps)
+{
+    QFile file(cacheFile());
+    if (!file.open(QFile::ReadOnly) || file.size() < qint64(sizeof(AppCatalogHeader))) {
+        return false;
+    }
+
+    uchar *data = file.map(0, file.size());
+    if (!data) {
+        return false;
+    }
+
+    bool accepted = false;
+    const auto header = reinterpret_cast<const AppCatalogHeader*>(data);
+    const char *payloadData = reinterpret_cast<const char*>(data + sizeof(AppCatalogHeader));
+
+    if (header->magic == APP_CATALOG_MAGIC && header->version == APP_CATALOG_VERSION
+        && qint64(header->payloadSize) == file.size() - qint64(sizeof(AppCatalogHeader))
+        && qstrncmp(header->locale, currentLocale().constData(), sizeof(AppCatalogHeader::locale)) == 0
+        && qChecksum(payloadData, header->payloadSize) == header->checksum) {
+
+        // 直接读取映射的内存，不拷贝文件内容
+        QByteArray payload = QByteArray::fromRawData(payloadData, int(header->payloadSize));
+        QDataStream stream(payload);
+        stream.setVersion(QDataStream::Qt_5_12);
+
+        DataEntityVector cachedApps;
+        cachedApps.reserve(int(header->count));
+        for (quint32 i = 0; i < header->count && stream.status() == QDataStream::Ok; ++i) {
+            QString id, name, icon, category, firstLetter, insertTime;
+            qint32 launchTimes, top, favorite;
+            quint8 flags;
+            stream >> id >> name >> icon >> category >> firstLetter >> insertTime >> launchTimes >> top >> favorite >> flags;
+
+            DataEntity app;
+            app.setId(id);
+            app.setName(name);
+            app.setIcon(icon);
+            app.setCategory(category);
+            app.setFirstLetter(firstLetter);
+            app.setInsertTime(insertTime);
+            app.setLaunchTimes(launchTimes);
+            app.setTop(top);
+            app.setFavorite(favorite);
+            app.setLock(flags & Locked);
+            app.setLaunched((flags & Launched) ? 1 : 0);
+            cachedApps.append(app);
+        }
+
+        if (stream.status() == QDataStream::Ok) {
+            apps.swap(cachedApps);
+            accepted = true;
+        }
+    }
+
+    file.unmap(data);
+    if (!accepted) {
+        qWarning() << "AppCatalogCache: drop invalid cache file" << file.fileName();
+    }
+
+    return accepted;
+}
+
+bool AppCatalogCache::save(const DataEntityVector &apps)
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    for (const auto &app : apps) {
+        quint8 flags = 0;
+        if (app.isLock()) {
+            flags |= Locked;
+        }
+        if (app.launched()) {
+            flags |= Launched;
+        }
+
+        stream << app.id() << app.name() << app.icon() << app.category() << app.firstLetter() << app.insertTime()
+               << qint32(app.launchTimes()) << qint32(app.top()) << qint32(app.favorite()) << flags;
+    }
+
+    AppCatalogHeader header {};
+    header.magic = APP_CATALOG_MAGIC;
+    header.version = APP_CATALOG_VERSION;
+    header.count = quint32(apps.size());
+    header.payloadSize = quint32(payload.size());
+    header.checksum = qChecksum(payload.constData(), uint(payload.size()));
+    const QByteArray locale = currentLocale();
+    qstrncpy(header.locale, locale.constData(), sizeof(header.locale));
+
+    QString path = cacheDir();
+    if (!QDir().mkpath(path)) {
+        qWarning() << "AppCatalogCache: could not create cache directory" << path;
+        return false;
+    }
+
+    // 先写入临时文件再替换，避免读取到不完整的快照
+    QSaveFile file(cacheFile());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload);
+    return file.commit();
+}
+
+bool AppCatalogCache::isSameApp(const DataEntity &a, const DataEntity &b)
+{
+    return a.id() == b.id() && a.name() == b.name() && a.icon() == b.icon()
+           && a.category() == b.category() && a.firstLetter() == b.firstLetter()
+           && a.insertTime() == b.insertTime() && a.launchTimes() == b.launchTimes()
+           && a.top() == b.top() && a.favorite() == b.favorite()
+           && a.isLock() == b.isLock() && bool(a.launched()) == bool(b.launched());
+}
+
+} // LingmoMenu
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINGMO_MENU_APP_CATALOG_CACHE_H
+#define LINGMO_MENU_APP_CATALOG_CACHE_H
+
+#include "app-database-interface.h"
+
+namespace LingmoMenu {
+
+/**
+ * @class AppCatalogCache
+ *
+ * 应用列表的本地快照，保存在 ~/.cache/lingmo-menu/ 下
+ * 启动时通过mmap读取快照快速填充model，再与数据库进行对比
+ * 文件头中记录了版本号、语言环境和校验值，任一不匹配时快照失效
+ */
+class AppCatalogCache
+{
+public:
+    /**
+     * 读取快照
+     * @param apps 读取到的应用
+     * @return 快照存在且有效时返回true
+     */
+    static bool load(DataEntityVector &apps);
+
+    /**
+     * 将应用列表写入快照
+     * @param apps 需要保存的应用
+     */
+    static bool save(const DataEntityVector &apps);
+
+    /**
+     * 比较两个应用在快照中保存的属性是否一致
+     */
+    static bool isSameApp(const DataEntity &a, const DataEntity &b);
+
+private:
+    static QString cacheDir();
+    static QString cacheFile();
+};
+
+} // LingmoMenu
+
+#endif //LINGMO_MENU_APP_CATALOG_CACHE_H
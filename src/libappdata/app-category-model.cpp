@@ -22,10 +22,11 @@
 #include "basic-app-model.h"
 
 #include <QDebug>
+#include <algorithm>
 
 namespace LingmoMenu {
 
-AppCategoryModel::AppCategoryModel(QObject *parent) : QSortFilterProxyModel(parent)
+AppCategoryModel::AppCategoryModel(QObject *parent) : QAbstractProxyModel(parent)
 {
     m_mainCategories.insert(QStringLiteral("Audio"), {tr("Audio"), 0});
     m_mainCategories.insert(QStringLiteral("AudioVideo"), {tr("AudioVideo"), 1});
@@ -42,8 +43,71 @@ AppCategoryModel::AppCategoryModel(QObject *parent) : QSortFilterProxyModel(pare
     m_mainCategories.insert(QStringLiteral("Video"), {tr("Video"), 12});
     m_mainCategories.insert(QStringLiteral("Other"), {tr("Other"), 13});
 
-    QSortFilterProxyModel::setSourceModel(BasicAppModel::instance());
-    QSortFilterProxyModel::sort(0);
+    m_categoryNames.resize(m_mainCategories.size());
+    for (const auto &category : m_mainCategories) {
+        m_categoryNames[category.second] = category.first;
+    }
+
+    BasicAppModel *sourceModel = BasicAppModel::instance();
+    QAbstractProxyModel::setSourceModel(sourceModel);
+
+    connect(sourceModel, &BasicAppModel::rowsInserted, this, &AppCategoryModel::onSourceRowsInserted);
+    connect(sourceModel, &BasicAppModel::rowsAboutToBeRemoved, this, &AppCategoryModel::onSourceRowsAboutToBeRemoved);
+    connect(sourceModel, &BasicAppModel::rowsRemoved, this, &AppCategoryModel::onSourceRowsRemoved);
+    connect(sourceModel, &BasicAppModel::dataChanged, this, &AppCategoryModel::onSourceDataChanged);
+    connect(sourceModel, &BasicAppModel::modelReset, this, &AppCategoryModel::onSourceModelReset);
+    connect(sourceModel, &BasicAppModel::layoutChanged, this, &AppCategoryModel::onSourceModelReset);
+    connect(sourceModel, &BasicAppModel::batchCommitted, this, &AppCategoryModel::onSourceBatchCommitted);
+
+    rebuild();
+}
+
+QModelIndex AppCategoryModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || column != 0 || row < 0 || row >= m_orders[m_mode].size()) {
+        return {};
+    }
+
+    return createIndex(row, column);
+}
+
+QModelIndex AppCategoryModel::parent(const QModelIndex &child) const
+{
+    return {};
+}
+
+int AppCategoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_orders[m_mode].size();
+}
+
+int AppCategoryModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+QModelIndex AppCategoryModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || proxyIndex.row() >= m_orders[m_mode].size()) {
+        return {};
+    }
+
+    return sourceModel()->index(m_orders[m_mode].at(proxyIndex.row()), 0);
+}
+
+QModelIndex AppCategoryModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid()) {
+        return {};
+    }
+
+    updateProxyRows();
+    int row = m_proxyRows.value(sourceIndex.row(), -1);
+    if (row < 0) {
+        return {};
+    }
+
+    return createIndex(row, 0);
 }
 
 AppCategoryModel::Mode AppCategoryModel::mode() const
@@ -57,9 +121,26 @@ void AppCategoryModel::setMode(AppCategoryModel::Mode mode)
         return;
     }
 
+    // 两种排序结果都已经存在，只需要更新索引映射
+    beginLayoutChange();
     m_mode = mode;
-    // TODO: 刷新
-    invalidate();
+    m_proxyRowsDirty = true;
+    endLayoutChange();
+}
+
+QStringList AppCategoryModel::groups() const
+{
+    QStringList groups;
+    const QMap<quint32, int> &counts = m_groupCounts[m_mode];
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        if (m_mode == FirstLatter) {
+            groups.append(QString(QChar(ushort(it.key()))));
+        } else {
+            groups.append(m_categoryNames.at(int(it.key())));
+        }
+    }
+
+    return groups;
 }
 
 QVariant AppCategoryModel::data(const QModelIndex &index, int role) const
@@ -69,49 +150,349 @@ QVariant AppCategoryModel::data(const QModelIndex &index, int role) const
     }
 
     if (role == DataEntity::Group) {
+        const SortKey &key = m_sortKeys.at(m_orders[m_mode].at(index.row()));
         if (m_mode == FirstLatter) {
-            return AppCategoryModel::getFirstLatterUpper(QSortFilterProxyModel::data(index, DataEntity::FirstLetter).toString());
+            return QString(key.letter);
         } else {
-            return getCategoryName(QSortFilterProxyModel::data(index, DataEntity::Category).toString());
+            return m_categoryNames.at(key.categoryIndex);
         }
     }
 
-    return QSortFilterProxyModel::data(index, role);
+    return QAbstractProxyModel::data(index, role);
+}
+
+AppCategoryModel::SortKey AppCategoryModel::createSortKey(int sourceRow) const
+{
+    QModelIndex sourceIndex = sourceModel()->index(sourceRow, 0);
+    // model使用的升序排序，为了保持使用次数多的在前，启动次数取反后放在低32位
+    quint64 launchTimes = qMax(0, sourceIndex.data(DataEntity::LaunchTimes).toInt());
+    quint64 launchKey = 0xFFFFFFFFu - qMin<quint64>(launchTimes, 0xFFFFFFFFu);
+
+    SortKey key;
+    key.categoryIndex = getCategoryIndex(sourceIndex.data(DataEntity::Category).toString());
+    key.letter = AppCategoryModel::getFirstLatterUpper(sourceIndex.data(DataEntity::FirstLetter).toString()).at(0);
+    key.keys[Category] = (quint64(key.categoryIndex) << 32) | launchKey;
+    key.keys[FirstLatter] = (quint64(key.letter.unicode()) << 32) | launchKey;
+
+    return key;
 }
 
-bool AppCategoryModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+bool AppCategoryModel::lessThan(Mode mode, int leftRow, int rightRow) const
 {
-    return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
+    quint64 left = m_sortKeys.at(leftRow).keys[mode];
+    quint64 right = m_sortKeys.at(rightRow).keys[mode];
+
+    return left < right || (left == right && leftRow < rightRow);
 }
 
-bool AppCategoryModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
+int AppCategoryModel::sortedPosition(Mode mode, int sourceRow) const
 {
-    int result = 0;
-    if (m_mode == FirstLatter) {
-        QString leftKey = AppCategoryModel::getFirstLatterUpper(source_left.data(DataEntity::FirstLetter).toString());
-        QString rightKey = AppCategoryModel::getFirstLatterUpper(source_right.data(DataEntity::FirstLetter).toString());
+    const QVector<int> &order = m_orders[mode];
+    auto it = std::lower_bound(order.constBegin(), order.constEnd(), sourceRow, [this, mode] (int left, int right) {
+        return lessThan(mode, left, right);
+    });
 
-        result = leftKey.compare(rightKey);
+    return int(it - order.constBegin());
+}
 
-    } else {
-        // 按分类进行排序
-        int leftIndex = getCategoryIndex(source_left.data(DataEntity::Category).toString());
-        int rightIndex = getCategoryIndex(source_right.data(DataEntity::Category).toString());
+void AppCategoryModel::insertSorted(Mode mode, int sourceRow)
+{
+    int position = sortedPosition(mode, sourceRow);
+    bool current = (mode == m_mode);
+
+    if (current) {
+        beginInsertRows(QModelIndex(), position, position);
+    }
+
+    m_orders[mode].insert(position, sourceRow);
+
+    if (current) {
+        m_proxyRowsDirty = true;
+        endInsertRows();
+    }
+}
+
+int AppCategoryModel::removeSorted(Mode mode, int sourceRow)
+{
+    QVector<int> &order = m_orders[mode];
+    int position = sortedPosition(mode, sourceRow);
+    if (position >= order.size() || order.at(position) != sourceRow) {
+        position = order.indexOf(sourceRow);
+    }
+
+    if (position >= 0) {
+        order.remove(position);
+    }
+
+    return position;
+}
+
+void AppCategoryModel::updateGroupCount(int sourceRow, int step)
+{
+    const SortKey &key = m_sortKeys.at(sourceRow);
+    for (int mode : {FirstLatter, Category}) {
+        quint32 group = quint32(key.keys[mode] >> 32);
+        int &count = m_groupCounts[mode][group];
+        count += step;
+        if (count <= 0) {
+            m_groupCounts[mode].remove(group);
+        }
+    }
+}
+
+void AppCategoryModel::rebuild()
+{
+    int rowCount = sourceModel()->rowCount();
+
+    m_sortKeys.clear();
+    m_sortKeys.reserve(rowCount);
+    m_groupCounts[FirstLatter].clear();
+    m_groupCounts[Category].clear();
+
+    QVector<int> order(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        m_sortKeys.append(createSortKey(row));
+        updateGroupCount(row, 1);
+        order[row] = row;
+    }
+
+    for (Mode mode : {FirstLatter, Category}) {
+        m_orders[mode] = order;
+        std::sort(m_orders[mode].begin(), m_orders[mode].end(), [this, mode] (int left, int right) {
+            return lessThan(mode, left, right);
+        });
+    }
+
+    m_proxyRowsDirty = true;
+}
+
+void AppCategoryModel::beginLayoutChange()
+{
+    Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
 
-        result = (leftIndex < rightIndex) ? -1 : (leftIndex > rightIndex) ? 1 : 0;
+    // 记录持久化索引对应的源数据行，布局变化后重新映射
+    m_layoutChangeIndexes = persistentIndexList();
+    m_layoutChangeRows.clear();
+    m_layoutChangeRows.reserve(m_layoutChangeIndexes.size());
+    for (const auto &index : m_layoutChangeIndexes) {
+        m_layoutChangeRows.append(m_orders[m_mode].value(index.row(), -1));
     }
+}
+
+void AppCategoryModel::endLayoutChange()
+{
+    updateProxyRows();
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(m_layoutChangeRows.size());
+    for (int sourceRow : m_layoutChangeRows) {
+        int row = m_proxyRows.value(sourceRow, -1);
+        newIndexes.append(row < 0 ? QModelIndex() : createIndex(row, 0));
+    }
+
+    changePersistentIndexList(m_layoutChangeIndexes, newIndexes);
+    m_layoutChangeIndexes.clear();
+    m_layoutChangeRows.clear();
+
+    Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void AppCategoryModel::updateProxyRows() const
+{
+    if (!m_proxyRowsDirty) {
+        return;
+    }
+
+    const QVector<int> &order = m_orders[m_mode];
+    m_proxyRows.fill(-1, m_sortKeys.size());
+    for (int row = 0; row < order.size(); ++row) {
+        m_proxyRows[order.at(row)] = row;
+    }
+
+    m_proxyRowsDirty = false;
+}
+
+void AppCategoryModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    int count = last - first + 1;
+    for (Mode mode : {FirstLatter, Category}) {
+        for (int &sourceRow : m_orders[mode]) {
+            if (sourceRow >= first) {
+                sourceRow += count;
+            }
+        }
+    }
+
+    m_sortKeys.insert(first, count, SortKey());
+    for (int row = first; row <= last; ++row) {
+        m_sortKeys[row] = createSortKey(row);
+        updateGroupCount(row, 1);
+    }
+
+    m_proxyRowsDirty = true;
+    for (int row = first; row <= last; ++row) {
+        // 非当前模式的排序结果静默更新
+        insertSorted(m_mode == Category ? FirstLatter : Category, row);
+        insertSorted(m_mode, row);
+    }
+}
+
+void AppCategoryModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    // 源数据被删除前先移除对应的行，此时源数据行号保持不变
+    updateProxyRows();
+    QVector<int> rows;
+    for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+        rows.append(m_proxyRows.value(sourceRow, -1));
+    }
+    std::sort(rows.begin(), rows.end());
+
+    QVector<int> &order = m_orders[m_mode];
+    int end = rows.size() - 1;
+    while (end >= 0 && rows.at(end) >= 0) {
+        int begin = end;
+        while (begin > 0 && rows.at(begin - 1) == rows.at(begin) - 1) {
+            --begin;
+        }
+
+        beginRemoveRows(QModelIndex(), rows.at(begin), rows.at(end));
+        order.remove(rows.at(begin), end - begin + 1);
+        m_proxyRowsDirty = true;
+        endRemoveRows();
+
+        end = begin - 1;
+    }
+
+    Mode other = (m_mode == Category) ? FirstLatter : Category;
+    for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+        removeSorted(other, sourceRow);
+        updateGroupCount(sourceRow, -1);
+    }
+}
+
+void AppCategoryModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    int count = last - first + 1;
+    for (Mode mode : {FirstLatter, Category}) {
+        for (int &sourceRow : m_orders[mode]) {
+            if (sourceRow > last) {
+                sourceRow -= count;
+            }
+        }
+    }
+
+    m_sortKeys.remove(first, count);
+    m_proxyRowsDirty = true;
+}
+
+void AppCategoryModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    int first = topLeft.row();
+    int last = bottomRight.row();
+
+    if (roles.isEmpty() || roles.contains(DataEntity::Category)
+        || roles.contains(DataEntity::FirstLetter) || roles.contains(DataEntity::LaunchTimes)) {
+        if (BasicAppModel::instance()->isInBatch()) {
+            // 批量修改期间只记录，提交时统一调整位置
+            for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+                m_pendingRows.append(sourceModel()->index(sourceRow, 0));
+            }
+        } else {
+            QVector<int> rows;
+            for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+                rows.append(sourceRow);
+            }
+            updateSortKeys(rows);
+        }
+    }
+
+    updateProxyRows();
+    int top = -1, bottom = -1;
+    for (int sourceRow = first; sourceRow <= last; ++sourceRow) {
+        int row = m_proxyRows.value(sourceRow, -1);
+        if (row < 0) {
+            continue;
+        }
+
+        top = (top < 0) ? row : qMin(top, row);
+        bottom = qMax(bottom, row);
+    }
+
+    if (top >= 0) {
+        Q_EMIT dataChanged(index(top, 0), index(bottom, 0), roles);
+    }
+}
+
+void AppCategoryModel::onSourceBatchCommitted()
+{
+    QVector<int> rows;
+    for (const auto &index : m_pendingRows) {
+        if (index.isValid()) {
+            rows.append(index.row());
+        }
+    }
+    m_pendingRows.clear();
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    updateSortKeys(rows);
+}
 
-    if (result == 0) {
-        // 分类相同时，按打开次数排序; model使用的升序排序，为了保持使用次数多的在前，所以此处使用 > 比较符，
-        return source_left.data(DataEntity::LaunchTimes).toInt() > source_right.data(DataEntity::LaunchTimes).toInt();
+/**
+ * 重新计算排序键，排序键变化的行移动到新的位置，所有移动只发送一次布局变化信号
+ */
+void AppCategoryModel::updateSortKeys(const QVector<int> &sourceRows)
+{
+    bool layoutChanging = false;
+
+    for (int sourceRow : sourceRows) {
+        SortKey key = createSortKey(sourceRow);
+        const SortKey &oldKey = m_sortKeys.at(sourceRow);
+        if (key.keys[FirstLatter] == oldKey.keys[FirstLatter] && key.keys[Category] == oldKey.keys[Category]) {
+            continue;
+        }
+
+        if (!layoutChanging) {
+            beginLayoutChange();
+            layoutChanging = true;
+        }
+
+        // 按旧的排序键移除，更新后重新插入
+        updateGroupCount(sourceRow, -1);
+        removeSorted(FirstLatter, sourceRow);
+        removeSorted(Category, sourceRow);
+
+        m_sortKeys[sourceRow] = key;
+        updateGroupCount(sourceRow, 1);
+        for (Mode mode : {FirstLatter, Category}) {
+            m_orders[mode].insert(sortedPosition(mode, sourceRow), sourceRow);
+        }
     }
 
-    return result < 0;
+    if (layoutChanging) {
+        m_proxyRowsDirty = true;
+        endLayoutChange();
+    }
 }
 
-inline QString AppCategoryModel::getCategoryName(const QString &categories) const
+void AppCategoryModel::onSourceModelReset()
 {
-    return m_mainCategories[getCategoryKey(categories)].first;
+    beginResetModel();
+    m_pendingRows.clear();
+    rebuild();
+    endResetModel();
 }
 
 inline int AppCategoryModel::getCategoryIndex(const QString &categories) const
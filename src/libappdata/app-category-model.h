@@ -23,11 +23,18 @@
 
 #include "app-list-plugin.h"
 #include <QAction>
-#include <QSortFilterProxyModel>
+#include <QAbstractProxyModel>
+#include <QPersistentModelIndex>
 
 namespace LingmoMenu {
 
-class AppCategoryModel : public QSortFilterProxyModel
+/**
+ * @class AppCategoryModel
+ *
+ * 同时维护按分类和按首字母两种排序结果，源数据变化时增量更新
+ * 切换模式时只需重新映射索引，不需要重新排序
+ */
+class AppCategoryModel : public QAbstractProxyModel
 {
     Q_OBJECT
 public:
@@ -38,24 +45,80 @@ public:
     Q_ENUM(Mode)
 
     explicit AppCategoryModel(QObject *parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
     QVariant data(const QModelIndex &index, int role) const override;
 
     Mode mode() const;
     void setMode(Mode mode);
 
-protected:
-    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
-    bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const override;
+    /**
+     * 当前模式下按顺序排列的分组名称
+     */
+    QStringList groups() const;
 
 private:
+    /**
+     * 每个源数据行的排序键，高32位为分类序号或首字母，低32位为反转后的启动次数
+     * 排序时只需比较整数，键相同时按源数据行号排序
+     */
+    struct SortKey
+    {
+        int categoryIndex {0};
+        QChar letter;
+        quint64 keys[2] {0, 0};
+    };
+
     static QString getFirstLatterUpper(const QString &pinyinName) ;
-    inline QString getCategoryName(const QString &categories) const;
     inline int getCategoryIndex(const QString &categories) const;
     QString getCategoryKey(const QString &categories) const;
 
+    SortKey createSortKey(int sourceRow) const;
+    bool lessThan(Mode mode, int leftRow, int rightRow) const;
+    int sortedPosition(Mode mode, int sourceRow) const;
+    void insertSorted(Mode mode, int sourceRow);
+    int removeSorted(Mode mode, int sourceRow);
+    void updateGroupCount(int sourceRow, int step);
+    void rebuild();
+
+    void beginLayoutChange();
+    void endLayoutChange();
+    void updateProxyRows() const;
+
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onSourceModelReset();
+    void onSourceBatchCommitted();
+    void updateSortKeys(const QVector<int> &sourceRows);
+
 private:
     Mode m_mode { Category };
     QMap<QString, QPair<QString, int> > m_mainCategories;
+    // 分类序号对应的分类名称
+    QVector<QString> m_categoryNames;
+
+    QVector<SortKey> m_sortKeys;
+    // 两种模式下的排序结果，proxy row -> source row
+    QVector<int> m_orders[2];
+    // 两种模式下每个分组的应用数量，分组键 -> 数量
+    QMap<quint32, int> m_groupCounts[2];
+    // 当前模式下 source row -> proxy row，延迟更新
+    mutable QVector<int> m_proxyRows;
+    mutable bool m_proxyRowsDirty {true};
+
+    QModelIndexList m_layoutChangeIndexes;
+    QVector<int> m_layoutChangeRows;
+    // 批量修改期间排序键可能变化的行
+    QVector<QPersistentModelIndex> m_pendingRows;
 };
 
 } // LingmoMenu
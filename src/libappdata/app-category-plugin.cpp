@@ -74,6 +74,10 @@ AppCategoryPlugin::AppCategoryPlugin(QObject *parent) : AppListPluginInterface(p
     connect(m_categoryModel, &AppCategoryModel::rowsRemoved, this, [=] {
         Q_EMIT labelChanged();
     });
+    // 应用分类变化时，分组可能增加或减少
+    connect(m_categoryModel, &AppCategoryModel::layoutChanged, this, [=] {
+        Q_EMIT labelChanged();
+    });
     connect(m_recentlyModel, &RecentlyInstalledModel::rowsInserted, this, [=] {
         Q_EMIT labelChanged();
     });
@@ -137,15 +141,8 @@ void AppCategoryPlugin::updateLabelBottle()
         labels << LabelItem(tr("Recently Installed"), "document-open-recent-symbolic", LabelItem::Icon);
     }
 
-    QHash<QString, int> groups;
-    int rowCount = m_categoryModel->rowCount();
-    for (int row = 0; row < rowCount; ++row) {
-        QString group = m_categoryModel->index(row, 0, QModelIndex()).data(DataEntity::Group).toString();
-        if (groups.contains(group)) {
-            continue;
-        }
-
-        groups.insert(group, 0);
+    // 分组信息由model增量维护，不需要遍历每一行
+    for (const auto &group : m_categoryModel->groups()) {
         labels.append(LabelItem(group, group));
     }
 
@@ -25,8 +25,15 @@
 
 #include <application-info.h>
 #include <QDebug>
+#include <QSet>
 
 #define APP_ICON_PREFIX "image://theme/"
+// 全量查询时每批返回给界面线程的应用数量
+#define APP_LOAD_BATCH_SIZE 256
+// 一次变化的应用数量达到应用总数的 1/APP_BATCH_QUERY_RATIO 时，使用一次带过滤条件的全量查询代替逐个查询
+// 全量查询只有一次往返，但会读取并传输所有应用的数据；逐个查询每个应用一次往返
+// 在变化的应用只占总数很小一部分时，全量查询读取的多余数据比节省的往返更多
+#define APP_BATCH_QUERY_RATIO 4
 
 namespace LingmoMenu {
 
@@ -39,11 +46,18 @@ public:
     explicit AppDatabaseWorkerPrivate(AppDatabaseInterface *parent = nullptr);
     DataEntityVector getAllApps();
     bool getApp(const QString &appid, DataEntity &app);
+    void loadApps(const AppDatabaseInterface::AppsCallback &callback);
 
     // 数据库操作函数
     void setAppProperty(const QString &appid, const LingmoSearch::ApplicationPropertyMap &propertyMap);
     void setAppProperty(const QString &appid, const LingmoSearch::ApplicationProperty::Property &property, const QVariant &value);
 
+public Q_SLOTS:
+    /**
+     * 在工作线程中初始化数据库链接
+     */
+    void initDatabase();
+
 private Q_SLOTS:
     /**
      * 应用数据库的添加信号处理函数
@@ -57,6 +71,7 @@ private Q_SLOTS:
 private:
     static void addInfoToApp(const QMap<LingmoSearch::ApplicationProperty::Property, QVariant> &info, DataEntity &app);
     bool isFilterAccepted(const LingmoSearch::ApplicationPropertyMap &appInfo) const;
+    QVector<LingmoSearch::ApplicationPropertyMap> getAcceptedInfos(const QStringList &appids, QStringList &rejectedApps);
 
 private:
     AppDatabaseInterface *q {nullptr};
@@ -65,24 +80,30 @@ private:
     LingmoSearch::ApplicationProperties  properties;
     // 设置我们需要的属性和值
     LingmoSearch::ApplicationPropertyMap filter;
+    // 满足过滤条件的应用id，其数量用于选择查询方式
+    QSet<QString> catalogIds;
+    // 首次启动时需要设置的默认收藏应用，在界面线程中读取，用户配置和全局设置不能在工作线程中访问
+    QStringList defaultFavoriteApps;
 };
 
-AppDatabaseWorkerPrivate::AppDatabaseWorkerPrivate(AppDatabaseInterface *parent) : QObject(parent), q(parent)
+AppDatabaseWorkerPrivate::AppDatabaseWorkerPrivate(AppDatabaseInterface *parent) : QObject(nullptr), q(parent)
 {
     // 注册需要在信号和槽函数中使用的数据结构
     qRegisterMetaType<LingmoMenu::DataEntityVector>("DataEntityVector");
+    qRegisterMetaType<QVector<QPair<LingmoMenu::DataEntity, QVector<int> > > >();
+}
 
+void AppDatabaseWorkerPrivate::initDatabase()
+{
     // 初始化应用数据库链接
     appDatabase = new LingmoSearch::ApplicationInfo(this);
 
-    // 首次启动时，为某些应用设置标志位
-    if (UserConfig::instance()->isFirstStartUp()) {
-        // 默认收藏应用
-        for (const auto &appid : GlobalSetting::instance()->defaultFavoriteApps()) {
-            appDatabase->setAppToFavorites(appid);
-            appDatabase->setAppLaunchedState(appid, true);
-        }
+    // 首次启动时，为默认收藏应用设置标志位
+    for (const auto &appid : defaultFavoriteApps) {
+        appDatabase->setAppToFavorites(appid);
+        appDatabase->setAppLaunchedState(appid, true);
     }
+    defaultFavoriteApps.clear();
 
     // 设置从数据库查询哪些属性
     properties << LingmoSearch::ApplicationProperty::Property::Top
@@ -147,6 +168,7 @@ bool AppDatabaseWorkerPrivate::isFilterAccepted(const LingmoSearch::ApplicationP
 DataEntityVector AppDatabaseWorkerPrivate::getAllApps()
 {
     LingmoSearch::ApplicationInfoMap appInfos = appDatabase->getInfo(properties, filter);
+    catalogIds = QSet<QString>::fromList(appInfos.keys());
     if (appInfos.isEmpty()) {
         return {};
     }
@@ -161,19 +183,32 @@ DataEntityVector AppDatabaseWorkerPrivate::getAllApps()
     return apps;
 }
 
+void AppDatabaseWorkerPrivate::loadApps(const AppDatabaseInterface::AppsCallback &callback)
+{
+    const DataEntityVector apps = getAllApps();
+
+    // 分批投递到界面线程，避免一次插入全部数据阻塞界面
+    int offset = 0;
+    do {
+        DataEntityVector batch = apps.mid(offset, APP_LOAD_BATCH_SIZE);
+        offset += APP_LOAD_BATCH_SIZE;
+        bool finished = offset >= apps.size();
+
+        QMetaObject::invokeMethod(q, [callback, batch, finished] {
+            callback(batch, finished);
+        }, Qt::QueuedConnection);
+    } while (offset < apps.size());
+}
+
 void AppDatabaseWorkerPrivate::onAppDatabaseAdded(const QStringList &infos)
 {
     if (infos.isEmpty()) {
         return;
     }
 
+    QStringList rejectedApps;
     DataEntityVector apps;
-    for (const QString &appid : infos) {
-        const LingmoSearch::ApplicationPropertyMap appInfo = appDatabase->getInfo(appid, properties);
-        if (!isFilterAccepted(appInfo)) {
-            continue;
-        }
-
+    for (const auto &appInfo : getAcceptedInfos(infos, rejectedApps)) {
         DataEntity app;
         addInfoToApp(appInfo, app);
         apps.append(app);
@@ -219,7 +254,8 @@ void AppDatabaseWorkerPrivate::onAppDatabaseUpdate(const LingmoSearch::Applicati
                     break;
                 case LingmoSearch::ApplicationProperty::InsertTime:
                     app.setInsertTime(it.value().toString());
-                    roles.append(DataEntity::Icon);
+                    roles.append(DataEntity::InstallationTime);
+                    roles.append(DataEntity::InstallTimestamp);
                     break;
                 case LingmoSearch::ApplicationProperty::Category:
                     app.setCategory(it.value().toString());
@@ -270,6 +306,9 @@ void AppDatabaseWorkerPrivate::onAppDatabaseDeleted(const QStringList &infos)
         return;
     }
 
+    for (const auto &appid : infos) {
+        catalogIds.remove(appid);
+    }
     Q_EMIT q->appDeleted(infos);
 }
 
@@ -279,19 +318,65 @@ void AppDatabaseWorkerPrivate::onAppDatabaseUpdateAll(const QStringList &infos)
         return;
     }
 
+    QStringList rejectedApps;
     QVector<QPair<DataEntity, QVector<int> > > updates;
-    DataEntityVector apps;
 
-    for (const auto &appid : infos) {
-        const LingmoSearch::ApplicationPropertyMap appInfo = appDatabase->getInfo(appid, properties);
+    for (const auto &appInfo : getAcceptedInfos(infos, rejectedApps)) {
         DataEntity app;
         addInfoToApp(appInfo, app);
-        apps.append(app);
-
         updates.append({app, {}});
     }
 
-    Q_EMIT q->appUpdated(updates);
+    if (!updates.isEmpty()) {
+        Q_EMIT q->appUpdated(updates);
+    }
+
+    // 更新后不再满足过滤条件的应用，需要从列表中移除
+    if (!rejectedApps.isEmpty()) {
+        Q_EMIT q->appDeleted(rejectedApps);
+    }
+}
+
+/**
+ * 查询一组应用的信息，并在同一次遍历中按filter进行过滤，同时更新catalogIds
+ * @param appids 需要查询的应用id列表
+ * @param rejectedApps 不满足过滤条件或已不存在的应用
+ * @return 满足过滤条件的应用信息，顺序与appids一致
+ */
+QVector<LingmoSearch::ApplicationPropertyMap> AppDatabaseWorkerPrivate::getAcceptedInfos(const QStringList &appids, QStringList &rejectedApps)
+{
+    QVector<LingmoSearch::ApplicationPropertyMap> infos;
+    infos.reserve(appids.size());
+
+    const int catalogSize = catalogIds.size();
+    if (catalogSize > 0 && appids.size() * APP_BATCH_QUERY_RATIO >= catalogSize) {
+        // 数据库会使用filter进行过滤，只需要一次查询，顺便与数据库重新同步
+        const LingmoSearch::ApplicationInfoMap acceptedInfos = appDatabase->getInfo(properties, filter);
+        catalogIds = QSet<QString>::fromList(acceptedInfos.keys());
+        for (const auto &appid : appids) {
+            auto it = acceptedInfos.constFind(appid);
+            if (it == acceptedInfos.constEnd()) {
+                rejectedApps.append(appid);
+            } else {
+                infos.append(it.value());
+            }
+        }
+
+        return infos;
+    }
+
+    for (const auto &appid : appids) {
+        const LingmoSearch::ApplicationPropertyMap appInfo = appDatabase->getInfo(appid, properties);
+        if (isFilterAccepted(appInfo)) {
+            infos.append(appInfo);
+            catalogIds.insert(appid);
+        } else {
+            rejectedApps.append(appid);
+            catalogIds.remove(appid);
+        }
+    }
+
+    return infos;
 }
 
 void AppDatabaseWorkerPrivate::setAppProperty(const QString &appid, const LingmoSearch::ApplicationPropertyMap &propertyMap)
@@ -333,15 +418,53 @@ bool AppDatabaseWorkerPrivate::getApp(const QString &appid, DataEntity &app)
 }
 
 // ====== AppDatabaseInterface ====== //
-// TODO: 多线程
 AppDatabaseInterface::AppDatabaseInterface(QObject *parent) : QObject(parent), d(new AppDatabaseWorkerPrivate(this))
 {
+    // 在工作线程启动前读取配置，工作线程只使用这份数据
+    if (UserConfig::instance()->isFirstStartUp()) {
+        d->defaultFavoriteApps = GlobalSetting::instance()->defaultFavoriteApps();
+    }
+
+    d->moveToThread(&m_workerThread);
+    // started信号在工作线程中发出，保证数据库链接在工作线程中创建
+    connect(&m_workerThread, &QThread::started, d, &AppDatabaseWorkerPrivate::initDatabase);
+
+    m_workerThread.setObjectName(QStringLiteral("AppDatabaseWorker"));
+    m_workerThread.start();
+}
+
+AppDatabaseInterface::~AppDatabaseInterface()
+{
+    m_workerThread.quit();
+    m_workerThread.wait();
+    delete d;
+}
+
+void AppDatabaseInterface::apps(const AppsCallback &callback) const
+{
+    if (!callback) {
+        return;
+    }
 
+    AppDatabaseWorkerPrivate *worker = d;
+    QMetaObject::invokeMethod(worker, [worker, callback] {
+        worker->loadApps(callback);
+    }, Qt::QueuedConnection);
 }
 
-DataEntityVector AppDatabaseInterface::apps() const
+bool AppDatabaseInterface::getApp(const QString &appid, DataEntity &app) const
 {
-    return d->getAllApps();
+    if (QThread::currentThread() == &m_workerThread) {
+        return d->getApp(appid, app);
+    }
+
+    bool found = false;
+    AppDatabaseWorkerPrivate *worker = d;
+    QMetaObject::invokeMethod(worker, [worker, &appid, &app, &found] {
+        found = worker->getApp(appid, app);
+    }, Qt::BlockingQueuedConnection);
+
+    return found;
 }
 
 void AppDatabaseInterface::fixAppToTop(const QString &appid, int index) const
@@ -350,7 +473,10 @@ void AppDatabaseInterface::fixAppToTop(const QString &appid, int index) const
         index = 0;
     }
 
-    d->setAppProperty(appid, LingmoSearch::ApplicationProperty::Top, index);
+    AppDatabaseWorkerPrivate *worker = d;
+    QMetaObject::invokeMethod(worker, [worker, appid, index] {
+        worker->setAppProperty(appid, LingmoSearch::ApplicationProperty::Top, index);
+    }, Qt::QueuedConnection);
 }
 
 void AppDatabaseInterface::fixAppToFavorite(const QString &appid, int index) const
@@ -359,17 +485,18 @@ void AppDatabaseInterface::fixAppToFavorite(const QString &appid, int index) con
         index = 0;
     }
 
-    d->setAppProperty(appid, LingmoSearch::ApplicationProperty::Favorites, index);
+    AppDatabaseWorkerPrivate *worker = d;
+    QMetaObject::invokeMethod(worker, [worker, appid, index] {
+        worker->setAppProperty(appid, LingmoSearch::ApplicationProperty::Favorites, index);
+    }, Qt::QueuedConnection);
 }
 
 void AppDatabaseInterface::updateApLaunchedState(const QString &appid, bool state) const
 {
-    d->setAppProperty(appid, LingmoSearch::ApplicationProperty::Launched, state);
-}
-
-bool AppDatabaseInterface::getApp(const QString &appid, DataEntity &app) const
-{
-    return d->getApp(appid, app);
+    AppDatabaseWorkerPrivate *worker = d;
+    QMetaObject::invokeMethod(worker, [worker, appid, state] {
+        worker->setAppProperty(appid, LingmoSearch::ApplicationProperty::Launched, state);
+    }, Qt::QueuedConnection);
 }
 
 } // LingmoMenu
@@ -23,6 +23,8 @@
 
 #include <QObject>
 #include <QPair>
+#include <QThread>
+#include <functional>
 #include "data-entity.h"
 
 namespace LingmoMenu {
@@ -31,6 +33,7 @@ typedef QVector<DataEntity> DataEntityVector;
 
 /**
  * 封装与应用数据库的链接
+ * 数据库的读写都在独立的工作线程中进行，查询结果通过回调或信号异步返回
  */
 class AppDatabaseWorkerPrivate;
 
@@ -38,22 +41,31 @@ class AppDatabaseInterface : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * @param apps 本批次查询到的应用
+     * @param finished 是否为最后一批数据
+     */
+    typedef std::function<void(const DataEntityVector &apps, bool finished)> AppsCallback;
+
     explicit AppDatabaseInterface(QObject *parent = nullptr);
+    ~AppDatabaseInterface() override;
 
     /**
-     * 从数据库获取全部应用
-     * @return
+     * 从数据库异步获取全部应用
+     * 结果分批返回，回调在AppDatabaseInterface所在的线程中执行
+     * @param callback 每批数据调用一次
      */
-    DataEntityVector apps() const;
+    void apps(const AppsCallback &callback) const;
     /**
-     * 从数据库获取单个应用
+     * 从数据库获取单个应用，会阻塞调用线程直到查询完成
+     * 不要在界面线程中调用
      * @param appid 应用id
      * @param app 获取应用
      */
     bool getApp(const QString &appid, DataEntity &app) const;
 
     /**
-     * 置顶应用
+     * 置顶应用，以下属性设置函数均为异步执行
      * @param appid 应用id
      * @param index 置顶后的位置，小于或等于0将会取消置顶
      */
@@ -97,6 +109,7 @@ Q_SIGNALS:
     void appDatabaseOpenFailed();
 
 private:
+    QThread m_workerThread;
     AppDatabaseWorkerPrivate *d {nullptr};
 };
 
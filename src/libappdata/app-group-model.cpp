@@ -20,6 +20,7 @@
 
 #include "app-group-model.h"
 #include <QDebug>
+#include <algorithm>
 
 namespace LingmoMenu {
 
@@ -36,12 +37,12 @@ QModelIndex AppGroupModel::index(int row, int column, const QModelIndex &parent)
 
     // 通过parent找到所属的组，将组的信息放入index附带数据中，作为判断依据
     if (parent.isValid()) {
-        const auto subItems = m_groups.at(parent.row());
-        if (row >= subItems->size()) {
+        const auto group = m_groups.at(parent.row());
+        if (row >= group->items.size()) {
             return {};
         }
 
-        return createIndex(row, column, subItems);
+        return createIndex(row, column, group);
     }
 
     return createIndex(row, column, nullptr);
@@ -53,9 +54,9 @@ QModelIndex AppGroupModel::parent(const QModelIndex &child) const
         return {};
     }
 
-    auto subItems = static_cast<QVector<int>*>(child.internalPointer());
-    if (subItems) {
-        return createIndex(m_groups.indexOf(subItems), 0);
+    auto group = static_cast<AppGroup*>(child.internalPointer());
+    if (group) {
+        return createIndex(m_groupIndexes.value(group->name, -1), 0);
     }
 
     return {};
@@ -100,7 +101,7 @@ int AppGroupModel::rowCount(const QModelIndex &parent) const
         return 0;
     }
 
-    return m_groups.at(i)->size();
+    return m_groups.at(i)->items.size();
 }
 
 int AppGroupModel::columnCount(const QModelIndex &parent) const
@@ -130,6 +131,7 @@ void AppGroupModel::setSourceModel(QAbstractItemModel *sourceModel)
         rebuildAppGroups();
 
         connect(sourceModel, &QAbstractItemModel::dataChanged, this, &AppGroupModel::onDataChanged);
+        connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &AppGroupModel::onLayoutAboutToBeChanged);
         connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &AppGroupModel::onLayoutChanged);
         connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &AppGroupModel::onRowsInserted);
         connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &AppGroupModel::onRowsAboutToBeRemoved);
@@ -141,6 +143,7 @@ void AppGroupModel::setSourceModel(QAbstractItemModel *sourceModel)
                 m_needRebuild = false;
 
             } else if (!parent.isValid()) {
+                m_sourceMap.remove(first, last - first + 1);
                 reLocationIndex(first, -(last - first + 1));
             }
         });
@@ -160,10 +163,9 @@ QModelIndex AppGroupModel::mapToSource(const QModelIndex &proxyIndex) const
         return {};
     }
 
-    auto subItems = static_cast<QVector<int>*>(proxyIndex.internalPointer());
-    if (subItems) {
-        int idx = subItems->at(proxyIndex.row());
-        return sourceModel()->index(idx, 0);
+    auto group = static_cast<AppGroup*>(proxyIndex.internalPointer());
+    if (group) {
+        return sourceModel()->index(group->sourceRow(proxyIndex.row()), 0);
     }
 
     return {};
@@ -175,13 +177,12 @@ QModelIndex AppGroupModel::mapFromSource(const QModelIndex &sourceIndex) const
         return {};
     }
 
-    int groupIndex = findGroupIndex(sourceIndex);
-    if (groupIndex < 0) {
+    const QPair<int, int> position = m_sourceMap.value(sourceIndex.row(), {-1, -1});
+    if (position.first < 0) {
         return {};
     }
 
-    int tempIndex = m_groups.at(groupIndex)->indexOf(sourceIndex.row());
-    return index(tempIndex, 0, index(groupIndex, 0, QModelIndex()));
+    return index(position.second, 0, index(position.first, 0, QModelIndex()));
 }
 
 QVariant AppGroupModel::data(const QModelIndex &proxyIndex, int role) const
@@ -195,7 +196,7 @@ QVariant AppGroupModel::data(const QModelIndex &proxyIndex, int role) const
     }
 
     if (role == DataEntity::Name || role == DataEntity::Group) {
-        return sourceModel()->index(m_groups.at(proxyIndex.row())->first(), 0).data(DataEntity::Group);
+        return m_groups.at(proxyIndex.row())->name;
     }
 
     return {};
@@ -205,89 +206,158 @@ void AppGroupModel::rebuildAppGroups()
 {
     qDeleteAll(m_groups);
     m_groups.clear();
+    m_groupIndexes.clear();
+
+    int rowCount = sourceModel()->rowCount();
+    m_sourceMap.resize(rowCount);
 
-    for (int i = 0; i < sourceModel()->rowCount(); ++i) {
-        int groupIndex = findGroupIndex(sourceModel()->index(i, 0));
-        QVector<int> *subItems {nullptr};
+    for (int i = 0; i < rowCount; ++i) {
+        // 使用group属性进行分组
+        QString group = sourceModel()->index(i, 0).data(DataEntity::Group).toString();
+        int groupIndex = m_groupIndexes.value(group, -1);
         if (groupIndex < 0) {
-            subItems = new QVector<int>();
-            m_groups.append(subItems);
-        } else {
-            subItems = m_groups[groupIndex];
+            groupIndex = m_groups.size();
+            m_groups.append(new AppGroup());
+            m_groups.last()->name = group;
+            m_groupIndexes.insert(group, groupIndex);
         }
 
-        subItems->append(i);
+        QVector<int> &items = m_groups[groupIndex]->items;
+        m_sourceMap[i] = {groupIndex, items.size()};
+        items.append(i);
     }
 }
 
-int AppGroupModel::findGroupIndex(const QModelIndex &sourceIndex) const
+void AppGroupModel::updateGroupIndexes(int from)
 {
-    for (int i = 0; i < m_groups.size(); ++i) {
-        const QVector<int> *subItems = m_groups.at(i);
-        if (subItems->isEmpty()) {
-            continue;
-        }
-
-        // 使用group属性进行分组
-        QString groupA = sourceIndex.data(DataEntity::Group).toString();
-        QString groupB = sourceModel()->index(subItems->at(0), 0).data(DataEntity::Group).toString();
-        if (groupA == groupB) {
-            return i;
+    for (int i = from; i < m_groups.size(); ++i) {
+        const AppGroup *group = m_groups.at(i);
+        m_groupIndexes[group->name] = i;
+        for (int item : group->items) {
+            m_sourceMap[item + group->offset].first = i;
         }
     }
+}
 
-    return -1;
+void AppGroupModel::updateItemPositions(int groupIndex, int from)
+{
+    const AppGroup *group = m_groups.at(groupIndex);
+    for (int i = from; i < group->items.size(); ++i) {
+        m_sourceMap[group->sourceRow(i)].second = i;
+    }
 }
 
-void AppGroupModel::insertApp(int groupIndex, const QModelIndex &sourceIndex)
+void AppGroupModel::insertApp(const QModelIndex &sourceIndex)
 {
-    int newIndex = sourceIndex.row();
-    if (groupIndex < 0 || groupIndex >= m_groups.size()) {
-        if (newIndex > 0) {
-            // 查找前一个item的index
-            newIndex = findGroupIndex(sourceModel()->index(--newIndex, 0));
-            if (newIndex < 0) {
-                newIndex = m_groups.size();
-            } else {
-                ++newIndex;
-            }
+    int sourceRow = sourceIndex.row();
+    QString group = sourceIndex.data(DataEntity::Group).toString();
+    int groupIndex = m_groupIndexes.value(group, -1);
+
+    if (groupIndex < 0) {
+        groupIndex = 0;
+        if (sourceRow > 0) {
+            // 新的组放在前一个item所在组的后面
+            int previous = m_sourceMap.value(sourceRow - 1, {-1, -1}).first;
+            groupIndex = (previous < 0) ? m_groups.size() : previous + 1;
         }
 
-        beginInsertRows(QModelIndex(), newIndex, newIndex);
-        m_groups.insert(newIndex, new QVector<int>(1, sourceIndex.row()));
+        beginInsertRows(QModelIndex(), groupIndex, groupIndex);
+        auto newGroup = new AppGroup();
+        newGroup->name = group;
+        newGroup->items.append(sourceRow);
+        m_groups.insert(groupIndex, newGroup);
+        m_sourceMap[sourceRow] = {groupIndex, 0};
+        updateGroupIndexes(groupIndex);
         endInsertRows();
         return;
     }
 
-    int index = 0;
-    QVector<int> *subItems = m_groups[groupIndex];
-    for (; index < subItems->size(); ++index) {
-        if (newIndex < subItems->at(index)) {
-            break;
-        }
-    }
+    // 组内按source row升序排列
+    AppGroup *appGroup = m_groups[groupIndex];
+    QVector<int> &items = appGroup->items;
+    int value = sourceRow - appGroup->offset;
+    int index = int(std::upper_bound(items.constBegin(), items.constEnd(), value) - items.constBegin());
 
     beginInsertRows(AppGroupModel::index(groupIndex, 0, QModelIndex()), index, index);
-    subItems->insert(index, newIndex);
+    items.insert(index, value);
+    updateItemPositions(groupIndex, index);
     endInsertRows();
 }
 
 // slots
 void AppGroupModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
+    bool groupChanged = roles.isEmpty() || roles.contains(DataEntity::Group);
     for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
-        QModelIndex proxyIndex = mapFromSource(sourceModel()->index(i, 0));
+        QModelIndex sourceIndex = sourceModel()->index(i, 0);
+        if (groupChanged) {
+            // 分组变化时从原来的分组中移除，再按新的分组插入
+            const QPair<int, int> position = m_sourceMap.value(i, {-1, -1});
+            if (position.first >= 0 && m_groups.at(position.first)->name != sourceIndex.data(DataEntity::Group).toString()) {
+                if (!removeApp(i)) {
+                    beginResetModel();
+                    rebuildAppGroups();
+                    endResetModel();
+                    return;
+                }
+
+                insertApp(sourceIndex);
+                continue;
+            }
+        }
+
+        QModelIndex proxyIndex = mapFromSource(sourceIndex);
         Q_EMIT dataChanged(proxyIndex, proxyIndex, roles);
     }
 }
 
+void AppGroupModel::onLayoutAboutToBeChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint)
+{
+    Q_UNUSED(parents)
+    Q_UNUSED(hint)
+    Q_EMIT layoutAboutToBeChanged();
+
+    // 应用行记录其在source中的索引，分组行记录分组名称，重新分组后按这些信息映射持久化索引
+    m_layoutChangeIndexes = persistentIndexList();
+    m_layoutChangeSourceIndexes.clear();
+    m_layoutChangeGroups.clear();
+    m_layoutChangeSourceIndexes.reserve(m_layoutChangeIndexes.size());
+    m_layoutChangeGroups.reserve(m_layoutChangeIndexes.size());
+    for (const auto &index : m_layoutChangeIndexes) {
+        if (index.internalPointer()) {
+            m_layoutChangeSourceIndexes.append(QPersistentModelIndex(mapToSource(index)));
+            m_layoutChangeGroups.append(QString());
+        } else {
+            m_layoutChangeSourceIndexes.append(QPersistentModelIndex());
+            m_layoutChangeGroups.append(m_groups.at(index.row())->name);
+        }
+    }
+}
+
 void AppGroupModel::onLayoutChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint)
 {
     Q_UNUSED(parents)
     Q_UNUSED(hint)
-    beginResetModel();
     rebuildAppGroups();
-    endResetModel();
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(m_layoutChangeIndexes.size());
+    for (int i = 0; i < m_layoutChangeIndexes.size(); ++i) {
+        const QPersistentModelIndex &sourceIndex = m_layoutChangeSourceIndexes.at(i);
+        if (sourceIndex.isValid()) {
+            newIndexes.append(mapFromSource(sourceIndex));
+        } else {
+            int groupIndex = m_groupIndexes.value(m_layoutChangeGroups.at(i), -1);
+            newIndexes.append(groupIndex < 0 ? QModelIndex() : index(groupIndex, 0, QModelIndex()));
+        }
+    }
+
+    changePersistentIndexList(m_layoutChangeIndexes, newIndexes);
+    m_layoutChangeIndexes.clear();
+    m_layoutChangeSourceIndexes.clear();
+    m_layoutChangeGroups.clear();
+
+    Q_EMIT layoutChanged();
 }
 
 void AppGroupModel::onRowsInserted(const QModelIndex &parent, int first, int last)
@@ -300,21 +370,29 @@ void AppGroupModel::onRowsInserted(const QModelIndex &parent, int first, int las
         reLocationIndex(first, (last - first + 1));
     }
 
+    m_sourceMap.insert(first, last - first + 1, {-1, -1});
     for (int i = first; i <= last; ++i) {
-        QModelIndex sourceIndex = sourceModel()->index(i, 0, parent);
-        insertApp(findGroupIndex(sourceIndex), sourceIndex);
+        insertApp(sourceModel()->index(i, 0, parent));
     }
 }
 
 void AppGroupModel::reLocationIndex(int base, int offset)
 {
-    for (QVector<int> *group : m_groups) {
-        QMutableVectorIterator<int> it(*group);
-        while (it.hasNext()) {
-            const int &value = it.next();
-            if (value >= base) {
-                it.setValue(value + offset);
-            }
+    for (AppGroup *group : m_groups) {
+        const QVector<int> &items = group->items;
+        if (items.isEmpty() || (items.last() + group->offset) < base) {
+            continue;
+        }
+
+        // 整个分组都在移动范围内时只修改偏移量，否则只移动base之后的部分
+        if ((items.first() + group->offset) >= base) {
+            group->offset += offset;
+            continue;
+        }
+
+        auto it = std::lower_bound(group->items.begin(), group->items.end(), base - group->offset);
+        for (; it != group->items.end(); ++it) {
+            *it += offset;
         }
     }
 }
@@ -325,45 +403,54 @@ void AppGroupModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first,
         return;
     }
 
-    int groupIndex = 0, itemIndex = 0;
     for (int i = first; i <= last; ++i) {
-        groupIndex = findGroupIndex(sourceModel()->index(i, 0));
-        if (groupIndex < 0) {
-            continue;
-        }
-
-        auto subItems = m_groups[groupIndex];
-        itemIndex = subItems->indexOf(i);
-        if (itemIndex < 0) {
+        if (!removeApp(i)) {
             // 如果出现错误，那么重新构建映射关系
             m_needRebuild = true;
             break;
         }
-
-        if (subItems->size() > 1) {
-            // 删除组里的元素
-            beginRemoveRows(index(groupIndex, 0, QModelIndex()), itemIndex, itemIndex);
-            subItems->removeAt(itemIndex);
-            endRemoveRows();
-        } else {
-            // 删除组
-            beginRemoveRows(QModelIndex(), groupIndex, groupIndex);
-            delete m_groups.takeAt(groupIndex);
-            endRemoveRows();
-        }
     }
 }
 
-int AppGroupModel::findLabelIndex(const QString &label) const
+/**
+ * 从所在的分组中移除一个source row，分组为空时删除该分组
+ * @return 映射关系与source不一致时返回false
+ */
+bool AppGroupModel::removeApp(int sourceRow)
 {
-    int rowCount = AppGroupModel::rowCount(QModelIndex());
-    for (int i = 0; i < rowCount; ++i) {
-        if (index(i, 0, QModelIndex()).data(DataEntity::Group).toString() == label) {
-            return i;
-        }
+    const QPair<int, int> position = m_sourceMap.value(sourceRow, {-1, -1});
+    if (position.first < 0) {
+        return true;
+    }
+
+    int groupIndex = position.first, itemIndex = position.second;
+    AppGroup *group = m_groups[groupIndex];
+    if (itemIndex >= group->items.size() || group->sourceRow(itemIndex) != sourceRow) {
+        return false;
+    }
+
+    m_sourceMap[sourceRow] = {-1, -1};
+    if (group->items.size() > 1) {
+        // 删除组里的元素
+        beginRemoveRows(index(groupIndex, 0, QModelIndex()), itemIndex, itemIndex);
+        group->items.removeAt(itemIndex);
+        updateItemPositions(groupIndex, itemIndex);
+        endRemoveRows();
+    } else {
+        // 删除组
+        beginRemoveRows(QModelIndex(), groupIndex, groupIndex);
+        m_groupIndexes.remove(group->name);
+        delete m_groups.takeAt(groupIndex);
+        updateGroupIndexes(groupIndex);
+        endRemoveRows();
     }
 
-    return -1;
+    return true;
+}
+
+int AppGroupModel::findLabelIndex(const QString &label) const
+{
+    return m_groupIndexes.value(label, -1);
 }
 
 } // LingmoMenu
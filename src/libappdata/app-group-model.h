@@ -58,20 +58,45 @@ public:
 
 private Q_SLOTS:
     void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onLayoutAboutToBeChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint);
     void onLayoutChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint);
     void onRowsInserted(const QModelIndex &parent, int first, int last);
     void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
 
 private:
+    /**
+     * 一个分组，items按source row升序存储
+     * 存储的值加上offset才是实际的source row，源数据行整体移动时只需要修改offset
+     */
+    struct AppGroup
+    {
+        QString name;
+        int offset {0};
+        QVector<int> items;
+
+        inline int sourceRow(int i) const { return items.at(i) + offset; }
+    };
+
     void rebuildAppGroups();
     void reLocationIndex(int base, int offset);
-    int findGroupIndex(const QModelIndex &sourceIndex) const;
-    void insertApp(int groupIndex, const QModelIndex &sourceIndex);
+    void insertApp(const QModelIndex &sourceIndex);
+    bool removeApp(int sourceRow);
+    void updateGroupIndexes(int from);
+    void updateItemPositions(int groupIndex, int from);
 
 private:
     // 存储分组信息
-    QVector<QVector<int>*> m_groups;
+    QVector<AppGroup*> m_groups;
+    // 分组名称 -> 分组序号
+    QHash<QString, int> m_groupIndexes;
+    // source row -> (分组序号, 组内位置)
+    QVector<QPair<int, int> > m_sourceMap;
     bool m_needRebuild {false};
+
+    // 布局变化前的持久化索引，以及对应的source索引(应用行)或分组名称(分组行)，只在布局变化期间存在
+    QModelIndexList m_layoutChangeIndexes;
+    QVector<QPersistentModelIndex> m_layoutChangeSourceIndexes;
+    QStringList m_layoutChangeGroups;
 };
 
 } // LingmoMenu
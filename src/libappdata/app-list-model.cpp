@@ -21,8 +21,11 @@
 #include "app-list-model.h"
 #include "data-entity.h"
 #include "context-menu-manager.h"
+#include "basic-app-model.h"
+#include "combined-list-model.h"
 
 #include <QDebug>
+#include <QAbstractProxyModel>
 
 namespace LingmoMenu {
 
@@ -93,10 +96,14 @@ void AppListHeader::removeAllAction()
 }
 
 // ====== //
-AppListModel::AppListModel(QObject *parent) : QSortFilterProxyModel(parent), m_header(new AppListHeader(this))
+AppListModel::AppListModel(QObject *parent) : QAbstractListModel(parent), m_header(new AppListHeader(this))
 {
     qRegisterMetaType<LingmoMenu::AppListModel*>();
     qRegisterMetaType<LingmoMenu::AppListHeader*>();
+
+    // 同步缓存的BasicAppModel行号
+    connect(BasicAppModel::instance(), &BasicAppModel::rowsAboutToBeInserted, this, &AppListModel::onAppRowsAboutToBeInserted);
+    connect(BasicAppModel::instance(), &BasicAppModel::rowsRemoved, this, &AppListModel::onAppRowsRemoved);
 }
 
 QHash<int, QByteArray> AppListModel::roleNames() const
@@ -104,6 +111,301 @@ QHash<int, QByteArray> AppListModel::roleNames() const
     return DataEntity::AppRoleNames();
 }
 
+int AppListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_items.size();
+}
+
+QVariant AppListModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const AppListItem &item = m_items.at(index.row());
+    if (role == DataEntity::Group) {
+        return item.group;
+    }
+
+    if (role == DataEntity::RecentInstall) {
+        return item.recentInstall;
+    }
+
+    if (item.appRow >= 0) {
+        BasicAppModel *model = BasicAppModel::instance();
+        return model->data(model->index(item.appRow, 0), role);
+    }
+
+    return m_sourceModel->index(index.row(), 0).data(role);
+}
+
+AppListModel::AppListItem AppListModel::createItem(int sourceRow) const
+{
+    QModelIndex sourceIndex = m_sourceModel->index(sourceRow, 0);
+
+    AppListItem item;
+    // 中间层model只会修改分组相关的数据，其余数据与BasicAppModel相同
+    item.group = sourceIndex.data(DataEntity::Group).toString();
+    item.recentInstall = sourceIndex.data(DataEntity::RecentInstall).toBool();
+
+    // 逐层映射到BasicAppModel
+    QModelIndex index = sourceIndex;
+    while (index.isValid() && index.model() != BasicAppModel::instance()) {
+        auto model = const_cast<QAbstractItemModel*>(index.model());
+        if (auto proxyModel = qobject_cast<QAbstractProxyModel*>(model)) {
+            index = proxyModel->mapToSource(index);
+        } else if (auto combinedModel = qobject_cast<CombinedListModel*>(model)) {
+            index = combinedModel->mapToSource(index);
+        } else {
+            index = QModelIndex();
+        }
+    }
+
+    item.appRow = index.isValid() ? index.row() : -1;
+    return item;
+}
+
+void AppListModel::resetItems()
+{
+    m_items.clear();
+    if (!m_sourceModel) {
+        return;
+    }
+
+    int rowCount = m_sourceModel->rowCount();
+    m_items.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        m_items.append(createItem(row));
+    }
+
+    resetLabelRows();
+}
+
+void AppListModel::resetLabelRows()
+{
+    m_labelRows.clear();
+    for (int row = m_items.size() - 1; row >= 0; --row) {
+        m_labelRows.insert(m_items.at(row).group, row);
+    }
+}
+
+/**
+ * 一行的分组变化后，更新原分组和新分组的第一行
+ * @param row 分组变化的行
+ * @param oldGroup 变化前的分组
+ */
+void AppListModel::updateLabelRow(int row, const QString &oldGroup)
+{
+    const QString &group = m_items.at(row).group;
+    if (group == oldGroup) {
+        return;
+    }
+
+    auto it = m_labelRows.find(oldGroup);
+    if (it != m_labelRows.end() && it.value() == row) {
+        // 原分组的第一行不再属于该分组，向后查找新的第一行
+        int next = row + 1;
+        while (next < m_items.size() && m_items.at(next).group != oldGroup) {
+            ++next;
+        }
+
+        if (next < m_items.size()) {
+            it.value() = next;
+        } else {
+            m_labelRows.erase(it);
+        }
+    }
+
+    it = m_labelRows.find(group);
+    if (it == m_labelRows.end()) {
+        m_labelRows.insert(group, row);
+    } else if (it.value() > row) {
+        it.value() = row;
+    }
+}
+
+void AppListModel::insertLabelRows(int first, int last)
+{
+    int count = last - first + 1;
+    for (auto it = m_labelRows.begin(); it != m_labelRows.end(); ++it) {
+        if (it.value() >= first) {
+            it.value() += count;
+        }
+    }
+
+    for (int row = first; row <= last; ++row) {
+        auto it = m_labelRows.find(m_items.at(row).group);
+        if (it == m_labelRows.end()) {
+            m_labelRows.insert(m_items.at(row).group, row);
+        } else if (it.value() > row) {
+            it.value() = row;
+        }
+    }
+}
+
+void AppListModel::removeLabelRows(int first, int last)
+{
+    int count = last - first + 1;
+    QStringList removedLabels;
+    for (auto it = m_labelRows.begin(); it != m_labelRows.end(); ++it) {
+        if (it.value() > last) {
+            it.value() -= count;
+        } else if (it.value() >= first) {
+            removedLabels.append(it.key());
+        }
+    }
+
+    // 分组的第一行被删除，从删除的位置向后查找该分组新的第一行
+    for (const auto &label : removedLabels) {
+        int row = first;
+        while (row < m_items.size() && m_items.at(row).group != label) {
+            ++row;
+        }
+
+        if (row < m_items.size()) {
+            m_labelRows[label] = row;
+        } else {
+            m_labelRows.remove(label);
+        }
+    }
+}
+
+void AppListModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), first, last);
+    m_items.insert(first, last - first + 1, AppListItem());
+    for (int row = first; row <= last; ++row) {
+        m_items[row] = createItem(row);
+    }
+    insertLabelRows(first, last);
+    endInsertRows();
+}
+
+void AppListModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), first, last);
+    m_items.remove(first, last - first + 1);
+    removeLabelRows(first, last);
+    endRemoveRows();
+}
+
+void AppListModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    int first = topLeft.row(), last = qMin(bottomRight.row(), m_items.size() - 1);
+    if (first < 0 || first > last) {
+        return;
+    }
+
+    if (roles.isEmpty() || roles.contains(DataEntity::Group) || roles.contains(DataEntity::Category)
+        || roles.contains(DataEntity::FirstLetter) || roles.contains(DataEntity::RecentInstall)) {
+        for (int row = first; row <= last; ++row) {
+            QString oldGroup = m_items.at(row).group;
+            m_items[row] = createItem(row);
+            updateLabelRow(row, oldGroup);
+        }
+    }
+
+    Q_EMIT dataChanged(index(first, 0), index(last, 0), roles);
+}
+
+void AppListModel::onSourceLayoutAboutToBeChanged()
+{
+    Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    // 布局变化只改变行的顺序，记录每一行在插件model中的索引，布局变化后按新的位置移动已有的数据
+    m_layoutSourceIndexes.clear();
+    m_layoutSourceIndexes.reserve(m_items.size());
+    for (int row = 0; row < m_items.size(); ++row) {
+        m_layoutSourceIndexes.append(QPersistentModelIndex(m_sourceModel->index(row, 0)));
+    }
+}
+
+void AppListModel::onSourceLayoutChanged()
+{
+    QVector<int> newRows(m_items.size(), -1);
+    QVector<AppListItem> items(m_sourceModel->rowCount());
+    QVector<bool> moved(items.size(), false);
+    for (int row = 0; row < m_layoutSourceIndexes.size(); ++row) {
+        int newRow = m_layoutSourceIndexes.at(row).row();
+        if (newRow < 0 || newRow >= items.size()) {
+            continue;
+        }
+
+        newRows[row] = newRow;
+        items[newRow] = m_items.at(row);
+        // 切换排序模式时分组会变化，且不会发送dataChanged信号
+        items[newRow].group = m_sourceModel->index(newRow, 0).data(DataEntity::Group).toString();
+        moved[newRow] = true;
+    }
+    m_layoutSourceIndexes.clear();
+
+    for (int row = 0; row < items.size(); ++row) {
+        if (!moved.at(row)) {
+            items[row] = createItem(row);
+        }
+    }
+    m_items.swap(items);
+    resetLabelRows();
+
+    const QModelIndexList oldIndexes = persistentIndexList();
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (const auto &index : oldIndexes) {
+        int row = newRows.value(index.row(), -1);
+        newIndexes.append(row < 0 ? QModelIndex() : AppListModel::index(row, 0));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+
+    Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void AppListModel::onSourceModelReset()
+{
+    beginResetModel();
+    resetItems();
+    endResetModel();
+}
+
+void AppListModel::onAppRowsAboutToBeInserted(const QModelIndex &parent, int first, int last)
+{
+    // BasicAppModel只在末尾追加应用，此时已有的行号不变
+    if (parent.isValid() || first >= BasicAppModel::instance()->rowCount(QModelIndex())) {
+        return;
+    }
+
+    int count = last - first + 1;
+    for (auto &item : m_items) {
+        if (item.appRow >= first) {
+            item.appRow += count;
+        }
+    }
+}
+
+void AppListModel::onAppRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    // 被删除的行已经通过插件model的信号移除，这里只调整后面的行号
+    int count = last - first + 1;
+    for (auto &item : m_items) {
+        if (item.appRow > last) {
+            item.appRow -= count;
+        } else if (item.appRow >= first) {
+            item.appRow = -1;
+        }
+    }
+}
+
 AppListHeader *AppListModel::getHeader() const
 {
     return m_header;
@@ -118,7 +420,20 @@ void AppListModel::installPlugin(AppListPluginInterface *plugin)
     unInstallPlugin();
 
     m_plugin = plugin;
-    QSortFilterProxyModel::setSourceModel(plugin->dataModel());
+
+    beginResetModel();
+    m_sourceModel = plugin->dataModel();
+    resetItems();
+    endResetModel();
+
+    if (m_sourceModel) {
+        connect(m_sourceModel, &QAbstractItemModel::rowsInserted, this, &AppListModel::onSourceRowsInserted);
+        connect(m_sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &AppListModel::onSourceRowsAboutToBeRemoved);
+        connect(m_sourceModel, &QAbstractItemModel::dataChanged, this, &AppListModel::onSourceDataChanged);
+        connect(m_sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &AppListModel::onSourceLayoutAboutToBeChanged);
+        connect(m_sourceModel, &QAbstractItemModel::layoutChanged, this, &AppListModel::onSourceLayoutChanged);
+        connect(m_sourceModel, &QAbstractItemModel::modelReset, this, &AppListModel::onSourceModelReset);
+    }
 
     for (const auto &action : plugin->actions()) {
         m_header->addAction(action);
@@ -143,7 +458,16 @@ void AppListModel::unInstallPlugin()
 
     m_header->setTitle("");
     m_header->removeAllAction();
-    QSortFilterProxyModel::setSourceModel(nullptr);
+    if (m_sourceModel) {
+        disconnect(m_sourceModel, nullptr, this, nullptr);
+    }
+
+    beginResetModel();
+    m_sourceModel = nullptr;
+    m_items.clear();
+    m_labelRows.clear();
+    endResetModel();
+
     disconnect(m_plugin, nullptr, this, nullptr);
     m_plugin = nullptr;
 
@@ -169,15 +493,7 @@ LabelBottle *AppListModel::labelBottle() const
 
 int AppListModel::findLabelIndex(const QString &label) const
 {
-    // TODO: 潜在的优化空间
-    int count = AppListModel::rowCount();
-    for (int i = 0; i < count; ++i) {
-        if (AppListModel::sourceModel()->index(i, 0).data(DataEntity::Group).toString() == label) {
-            return i;
-        }
-    }
-
-    return -1;
+    return m_labelRows.value(label, -1);
 }
 
 } // LingmoMenu
@@ -25,7 +25,8 @@
 #include "context-menu-extension.h"
 
 #include <QAction>
-#include <QSortFilterProxyModel>
+#include <QAbstractListModel>
+#include <QPersistentModelIndex>
 
 namespace LingmoMenu {
 
@@ -67,7 +68,13 @@ private:
     QList<QAction*> m_actions;
 };
 
-class AppListModel : public QSortFilterProxyModel
+/**
+ * @class AppListModel
+ *
+ * 将插件model展开为一个平铺的列表，每一行缓存分组信息和对应的BasicAppModel索引
+ * 获取数据时直接访问BasicAppModel，不需要经过插件内部的多层代理model
+ */
+class AppListModel : public QAbstractListModel
 {
     Q_OBJECT
     Q_PROPERTY(LingmoMenu::AppListHeader *header READ getHeader NOTIFY headerChanged)
@@ -80,6 +87,8 @@ public:
      * @return
      */
     QHash<int, QByteArray> roleNames() const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
 
     AppListHeader *getHeader() const;
     LabelBottle *labelBottle() const;
@@ -95,9 +104,42 @@ Q_SIGNALS:
     void headerChanged();
     void labelBottleChanged();
 
+private:
+    struct AppListItem
+    {
+        // 对应BasicAppModel中的行，不属于BasicAppModel的数据为-1
+        // 不使用持久化索引，避免BasicAppModel每次增删行时都要更新每一行的持久化索引
+        int appRow {-1};
+        QString group;
+        bool recentInstall {false};
+    };
+
+    AppListItem createItem(int sourceRow) const;
+    void resetItems();
+    void resetLabelRows();
+    void updateLabelRow(int row, const QString &oldGroup);
+    void insertLabelRows(int first, int last);
+    void removeLabelRows(int first, int last);
+
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onSourceLayoutAboutToBeChanged();
+    void onSourceLayoutChanged();
+    void onSourceModelReset();
+    void onAppRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
+    void onAppRowsRemoved(const QModelIndex &parent, int first, int last);
+
 private:
     AppListHeader *m_header {nullptr};
     AppListPluginInterface *m_plugin {nullptr};
+    QAbstractItemModel *m_sourceModel {nullptr};
+    QVector<AppListItem> m_items;
+    // 分组名称 -> 该分组的第一行
+    QHash<QString, int> m_labelRows;
+
+    // 布局变化前每一行对应的插件model索引，只在布局变化期间存在
+    QVector<QPersistentModelIndex> m_layoutSourceIndexes;
 };
 
 } // LingmoMenu
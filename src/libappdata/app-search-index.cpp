@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "app-search-index.h"
+#include "basic-app-model.h"
+
+#include <QSet>
+#include <QFileInfo>
+
+#include <algorithm>
+
+// 字段之间的分隔符，关键字中不会出现
+#define SEARCH_FIELD_SEPARATOR QLatin1Char('\n')
+
+// 各种匹配方式的基础分数，同一方式内匹配位置越靠前、跨度越小分数越高
+// 相邻两种方式相差SEARCH_SCORE_BAND，大于扣分上限与启动次数加分上限之和，加分后不会超过更好的匹配方式
+#define SEARCH_SCORE_BAND            200
+#define SEARCH_SCORE_NAME_PREFIX     (SEARCH_SCORE_BAND * 7)
+#define SEARCH_SCORE_NAME_CONTAINS   (SEARCH_SCORE_BAND * 6)
+#define SEARCH_SCORE_LETTER_PREFIX   (SEARCH_SCORE_BAND * 5)
+#define SEARCH_SCORE_LETTER_CONTAINS (SEARCH_SCORE_BAND * 4)
+#define SEARCH_SCORE_TEXT_CONTAINS   (SEARCH_SCORE_BAND * 3)
+#define SEARCH_SCORE_NAME_FUZZY      (SEARCH_SCORE_BAND * 2)
+#define SEARCH_SCORE_LETTER_FUZZY    (SEARCH_SCORE_BAND * 1)
+// 位置和跨度的扣分上限
+#define SEARCH_SCORE_MAX_PENALTY     99
+// 启动次数每增加一倍的加分和加分上限
+#define SEARCH_FRECENCY_STEP         8
+#define SEARCH_FRECENCY_MAX_BONUS    64
+// 删除的条目超过该数量且超过总数一半时整理倒排表
+#define SEARCH_INDEX_COMPACT_THRESHOLD 64
+
+static_assert(SEARCH_SCORE_BAND > SEARCH_SCORE_MAX_PENALTY + SEARCH_FRECENCY_MAX_BONUS,
+              "the score of a match kind must stay below the next better kind");
+
+namespace LingmoMenu {
+
+AppSearchIndex::AppSearchIndex(QObject *parent) : QObject(parent)
+{
+    BasicAppModel *model = BasicAppModel::instance();
+    connect(model, &BasicAppModel::rowsInserted, this, &AppSearchIndex::onRowsInserted);
+    connect(model, &BasicAppModel::rowsAboutToBeRemoved, this, &AppSearchIndex::onRowsAboutToBeRemoved);
+    connect(model, &BasicAppModel::dataChanged, this, &AppSearchIndex::onDataChanged);
+    connect(model, &BasicAppModel::modelReset, this, &AppSearchIndex::rebuild);
+
+    rebuild();
+}
+
+AppSearchResults AppSearchIndex::search(const QString &keyword) const
+{
+    const QString key = keyword.trimmed().toLower();
+    if (key.isEmpty()) {
+        return {};
+    }
+
+    // 关键字中最少出现的字符的倒排表，模糊匹配和子串匹配的应用都在其中
+    const QVector<int> *charCandidates = nullptr;
+    for (const QChar &c : key) {
+        auto it = m_chars.constFind(c.unicode());
+        if (it == m_chars.constEnd()) {
+            return {};
+        }
+
+        if (!charCandidates || it.value().size() < charCandidates->size()) {
+            charCandidates = &it.value();
+        }
+    }
+
+    // 关键字中最少出现的二元组的倒排表，子串匹配的应用都在其中，单个字符时使用字符的倒排表
+    const QVector<int> *candidates = (key.size() == 1) ? charCandidates : nullptr;
+    for (int i = 0; i + 1 < key.size(); ++i) {
+        auto it = m_bigrams.constFind(bigram(key.at(i), key.at(i + 1)));
+        if (it == m_bigrams.constEnd()) {
+            candidates = nullptr;
+            break;
+        }
+
+        if (!candidates || it.value().size() < candidates->size()) {
+            candidates = &it.value();
+        }
+    }
+
+    AppSearchResults results;
+    // 子串匹配的条目，按位置升序
+    QVector<int> matched;
+    if (candidates) {
+        for (int index : *candidates) {
+            const Entry &entry = m_entries.at(index);
+            if (!entry.valid) {
+                continue;
+            }
+
+            int score = substringScore(entry, key);
+            if (score > 0) {
+                matched.append(index);
+                appendResult(results, entry, score);
+            }
+        }
+    }
+
+    // 模糊匹配，跳过已经子串匹配的条目，两个列表都按位置升序
+    const quint64 keyMask = charMask(key);
+    int next = 0;
+    for (int index : *charCandidates) {
+        while (next < matched.size() && matched.at(next) < index) {
+            ++next;
+        }
+        if (next < matched.size() && matched.at(next) == index) {
+            continue;
+        }
+
+        const Entry &entry = m_entries.at(index);
+        // 关键字中有应用字段里没有的字符，不可能匹配
+        if (!entry.valid || (keyMask & ~entry.mask)) {
+            continue;
+        }
+
+        int score = fuzzyScore(entry, key);
+        if (score > 0) {
+            appendResult(results, entry, score);
+        }
+    }
+
+    return results;
+}
+
+AppSearchResults AppSearchIndex::refine(const AppSearchResults &results, const QString &keyword) const
+{
+    const QString key = keyword.trimmed().toLower();
+    if (key.isEmpty()) {
+        return {};
+    }
+
+    const quint64 keyMask = charMask(key);
+
+    AppSearchResults refined;
+    for (const AppSearchResult &result : results) {
+        auto it = m_entryIndexes.constFind(result.app.id());
+        if (it == m_entryIndexes.constEnd()) {
+            continue;
+        }
+
+        const Entry &entry = m_entries.at(it.value());
+        if (keyMask & ~entry.mask) {
+            continue;
+        }
+
+        int score = matchScore(entry, key);
+        if (score <= 0) {
+            continue;
+        }
+
+        // 使用最新的应用数据
+        appendResult(refined, entry, score);
+    }
+
+    return refined;
+}
+
+int AppSearchIndex::score(const DataEntity &app, const QString &keyword)
+{
+    const QString key = keyword.trimmed().toLower();
+    if (key.isEmpty()) {
+        return 0;
+    }
+
+    return matchScore(createEntry(app), key);
+}
+
+int AppSearchIndex::frecency(const DataEntity &app)
+{
+    // 未启动过的应用没有加分，启动次数按对数增长
+    if (app.launched() == 0 || app.launchTimes() <= 0) {
+        return 0;
+    }
+
+    int bonus = 0;
+    for (int times = app.launchTimes(); times > 0 && bonus < SEARCH_FRECENCY_MAX_BONUS; times >>= 1) {
+        bonus += SEARCH_FRECENCY_STEP;
+    }
+
+    return qMin(bonus, SEARCH_FRECENCY_MAX_BONUS);
+}
+
+quint64 AppSearchIndex::revision() const
+{
+    return m_revision;
+}
+
+AppSearchIndex::Entry AppSearchIndex::createEntry(const DataEntity &app)
+{
+    // 只使用desktop文件名，不包括路径和后缀
+    QString desktopName = QFileInfo(app.id()).completeBaseName();
+
+    Entry entry;
+    entry.id = app.id();
+    entry.name = app.name().toLower();
+    entry.letters = app.firstLetter().toLower();
+
+    entry.text.reserve(entry.name.size() + entry.letters.size() + desktopName.size() + app.category().size() + 3);
+    entry.text.append(entry.name).append(SEARCH_FIELD_SEPARATOR)
+        .append(entry.letters).append(SEARCH_FIELD_SEPARATOR)
+        .append(desktopName.toLower()).append(SEARCH_FIELD_SEPARATOR)
+        .append(app.category().toLower());
+
+    entry.mask = charMask(entry.text);
+    entry.valid = true;
+    return entry;
+}
+
+inline quint64 AppSearchIndex::charMask(const QString &text)
+{
+    // 按字符编码的低6位映射，不同字符可能对应同一位，只用于排除
+    quint64 mask = 0;
+    const ushort *data = text.utf16();
+    for (int i = 0, size = text.size(); i < size; ++i) {
+        mask |= quint64(1) << (data[i] & 63);
+    }
+
+    return mask;
+}
+
+inline quint32 AppSearchIndex::bigram(const QChar &a, const QChar &b)
+{
+    return (quint32(a.unicode()) << 16) | b.unicode();
+}
+
+int AppSearchIndex::subsequenceSpan(const QString &text, const QString &key)
+{
+    // 按顺序查找关键字的每个字符，返回从第一个到最后一个匹配字符的跨度，未匹配时返回-1
+    const ushort *t = text.utf16();
+    const ushort *k = key.utf16();
+    const int textSize = text.size();
+    const int keySize = key.size();
+
+    int first = -1;
+    for (int i = 0, j = 0; i < textSize; ++i) {
+        if (t[i] != k[j]) {
+            continue;
+        }
+
+        if (j == 0) {
+            first = i;
+        }
+
+        if (++j == keySize) {
+            return i - first + 1;
+        }
+    }
+
+    return -1;
+}
+
+int AppSearchIndex::substringScore(const Entry &entry, const QString &key)
+{
+    int pos = entry.name.indexOf(key);
+    if (pos == 0) {
+        return SEARCH_SCORE_NAME_PREFIX;
+    }
+    if (pos > 0) {
+        return SEARCH_SCORE_NAME_CONTAINS - qMin(pos, SEARCH_SCORE_MAX_PENALTY);
+    }
+
+    pos = entry.letters.indexOf(key);
+    if (pos == 0) {
+        return SEARCH_SCORE_LETTER_PREFIX;
+    }
+    if (pos > 0) {
+        return SEARCH_SCORE_LETTER_CONTAINS - qMin(pos, SEARCH_SCORE_MAX_PENALTY);
+    }
+
+    if (entry.text.contains(key)) {
+        return SEARCH_SCORE_TEXT_CONTAINS;
+    }
+
+    return 0;
+}
+
+int AppSearchIndex::fuzzyScore(const Entry &entry, const QString &key)
+{
+    // 跨度中多出的字符越少越相关
+    int span = subsequenceSpan(entry.name, key);
+    if (span > 0) {
+        return SEARCH_SCORE_NAME_FUZZY - qMin(span - key.size(), SEARCH_SCORE_MAX_PENALTY);
+    }
+
+    span = subsequenceSpan(entry.letters, key);
+    if (span > 0) {
+        return SEARCH_SCORE_LETTER_FUZZY - qMin(span - key.size(), SEARCH_SCORE_MAX_PENALTY);
+    }
+
+    return 0;
+}
+
+int AppSearchIndex::matchScore(const Entry &entry, const QString &key)
+{
+    int score = substringScore(entry, key);
+    if (score > 0) {
+        return score;
+    }
+
+    return fuzzyScore(entry, key);
+}
+
+void AppSearchIndex::appendResult(AppSearchResults &results, const Entry &entry, int score) const
+{
+    AppSearchResult result;
+    if (BasicAppModel::instance()->getAppById(entry.id, result.app)) {
+        result.score = score;
+        results.append(result);
+    }
+}
+
+void AppSearchIndex::collectKeys(const QString &text, QSet<quint32> &bigrams, QSet<ushort> &chars)
+{
+    for (int i = 0; i < text.size(); ++i) {
+        chars.insert(text.at(i).unicode());
+        if (i + 1 < text.size()) {
+            bigrams.insert(bigram(text.at(i), text.at(i + 1)));
+        }
+    }
+}
+
+template <typename Key>
+void AppSearchIndex::insertPosting(QHash<Key, QVector<int> > &postings, Key key, int index)
+{
+    QVector<int> &list = postings[key];
+    list.insert(std::lower_bound(list.begin(), list.end(), index), index);
+}
+
+template <typename Key>
+void AppSearchIndex::removePosting(QHash<Key, QVector<int> > &postings, Key key, int index)
+{
+    auto it = postings.find(key);
+    if (it == postings.end()) {
+        return;
+    }
+
+    QVector<int> &list = it.value();
+    auto pos = std::lower_bound(list.begin(), list.end(), index);
+    if (pos != list.end() && *pos == index) {
+        list.erase(pos);
+    }
+
+    if (list.isEmpty()) {
+        postings.erase(it);
+    }
+}
+
+void AppSearchIndex::insertEntry(const Entry &entry)
+{
+    int index = m_entries.size();
+    m_entries.append(entry);
+    m_entryIndexes.insert(entry.id, index);
+
+    // 条目按加入顺序递增，倒排表保持有序
+    QSet<quint32> bigrams;
+    QSet<ushort> chars;
+    collectKeys(entry.text, bigrams, chars);
+
+    for (quint32 key : bigrams) {
+        m_bigrams[key].append(index);
+    }
+
+    for (ushort key : chars) {
+        m_chars[key].append(index);
+    }
+}
+
+void AppSearchIndex::addApp(const DataEntity &app)
+{
+    if (app.id().isEmpty() || m_entryIndexes.contains(app.id())) {
+        return;
+    }
+
+    insertEntry(createEntry(app));
+    ++m_revision;
+}
+
+/**
+ * 原位更新条目，文本变化时只修改增加或减少的二元组和字符的倒排表，不产生已删除的条目
+ */
+void AppSearchIndex::updateApp(const DataEntity &app)
+{
+    auto it = m_entryIndexes.constFind(app.id());
+    if (it == m_entryIndexes.constEnd()) {
+        addApp(app);
+        return;
+    }
+
+    const int index = it.value();
+    Entry entry = createEntry(app);
+    Entry &oldEntry = m_entries[index];
+    if (entry.text == oldEntry.text) {
+        return;
+    }
+
+    QSet<quint32> oldBigrams, newBigrams;
+    QSet<ushort> oldChars, newChars;
+    collectKeys(oldEntry.text, oldBigrams, oldChars);
+    collectKeys(entry.text, newBigrams, newChars);
+
+    for (quint32 key : oldBigrams) {
+        if (!newBigrams.contains(key)) {
+            removePosting(m_bigrams, key, index);
+        }
+    }
+    for (quint32 key : newBigrams) {
+        if (!oldBigrams.contains(key)) {
+            insertPosting(m_bigrams, key, index);
+        }
+    }
+
+    for (ushort key : oldChars) {
+        if (!newChars.contains(key)) {
+            removePosting(m_chars, key, index);
+        }
+    }
+    for (ushort key : newChars) {
+        if (!oldChars.contains(key)) {
+            insertPosting(m_chars, key, index);
+        }
+    }
+
+    oldEntry = entry;
+    ++m_revision;
+}
+
+void AppSearchIndex::removeApp(const QString &appid)
+{
+    auto it = m_entryIndexes.find(appid);
+    if (it == m_entryIndexes.end()) {
+        return;
+    }
+
+    // 倒排表中的位置在整理时清理
+    Entry &entry = m_entries[it.value()];
+    entry = Entry();
+    m_entryIndexes.erase(it);
+    ++m_removedCount;
+    ++m_revision;
+
+    if (m_removedCount > SEARCH_INDEX_COMPACT_THRESHOLD && m_removedCount * 2 > m_entries.size()) {
+        compact();
+    }
+}
+
+/**
+ * 使用仍然有效的条目重建倒排表，不读取BasicAppModel，在删除行的过程中也可以调用
+ */
+void AppSearchIndex::compact()
+{
+    QVector<Entry> entries;
+    entries.swap(m_entries);
+    m_entries.reserve(entries.size() - m_removedCount);
+    m_entryIndexes.clear();
+    m_bigrams.clear();
+    m_chars.clear();
+    m_removedCount = 0;
+
+    for (const Entry &entry : entries) {
+        if (entry.valid) {
+            insertEntry(entry);
+        }
+    }
+}
+
+void AppSearchIndex::rebuild()
+{
+    m_entries.clear();
+    m_entryIndexes.clear();
+    m_bigrams.clear();
+    m_chars.clear();
+    m_removedCount = 0;
+    ++m_revision;
+
+    BasicAppModel *model = BasicAppModel::instance();
+    int rowCount = model->rowCount(QModelIndex());
+    m_entries.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        addApp(model->appOfIndex(row));
+    }
+}
+
+void AppSearchIndex::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        addApp(BasicAppModel::instance()->appOfIndex(row));
+    }
+}
+
+void AppSearchIndex::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        removeApp(BasicAppModel::instance()->appOfIndex(row).id());
+    }
+}
+
+void AppSearchIndex::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if (!roles.isEmpty() && !roles.contains(DataEntity::Name)
+        && !roles.contains(DataEntity::FirstLetter) && !roles.contains(DataEntity::Category)) {
+        return;
+    }
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        updateApp(BasicAppModel::instance()->appOfIndex(row));
+    }
+}
+
+} // LingmoMenu
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINGMO_MENU_APP_SEARCH_INDEX_H
+#define LINGMO_MENU_APP_SEARCH_INDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "app-database-interface.h"
+
+namespace LingmoMenu {
+
+/**
+ * 搜索结果及其匹配分数，分数越高越相关
+ */
+struct AppSearchResult
+{
+    DataEntity app;
+    int score {0};
+};
+
+typedef QVector<AppSearchResult> AppSearchResults;
+
+/**
+ * @class AppSearchIndex
+ *
+ * 应用名称、拼音首字母、desktop文件名和分类的本地搜索索引
+ * 使用二元组(bigram)倒排表筛选子串匹配的候选应用，使用单个字符的倒排表筛选模糊匹配的候选应用
+ * 只对候选应用计算匹配分数，通过BasicAppModel的信号增量更新
+ */
+class AppSearchIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AppSearchIndex(QObject *parent = nullptr);
+
+    /**
+     * 搜索与关键字匹配的应用，包括子串匹配和按顺序包含关键字所有字符的模糊匹配
+     * @param keyword 关键字，不区分大小写
+     * @return 匹配的应用和分数，未排序
+     */
+    AppSearchResults search(const QString &keyword) const;
+
+    /**
+     * 从上一次的搜索结果中筛选与关键字匹配的应用，并重新计算分数
+     * 新关键字包含上一次的关键字时，结果与重新搜索相同
+     * @param results 上一次的搜索结果
+     * @param keyword 关键字，不区分大小写
+     * @return 匹配的应用和分数，保持原有顺序
+     */
+    AppSearchResults refine(const AppSearchResults &results, const QString &keyword) const;
+
+    /**
+     * 计算不在索引中的应用(如搜索服务返回的结果)的匹配分数
+     * @return 分数，不匹配时为0
+     */
+    static int score(const DataEntity &app, const QString &keyword);
+
+    /**
+     * 按相关度排序时根据启动次数的加分，加上后不会超过更好的匹配方式的分数
+     * @return 加分，未启动过的应用为0
+     */
+    static int frecency(const DataEntity &app);
+
+    /**
+     * 索引内容每次变化时递增，用于判断之前的搜索结果是否仍然完整
+     */
+    quint64 revision() const;
+
+private:
+    struct Entry
+    {
+        QString id;
+        // 以下字段均为小写
+        QString name;
+        QString letters;
+        QString text;
+        // 字段中出现过的字符，每个字符对应一位
+        quint64 mask {0};
+        bool valid {false};
+    };
+
+    static Entry createEntry(const DataEntity &app);
+    static inline quint64 charMask(const QString &text);
+    static inline quint32 bigram(const QChar &a, const QChar &b);
+    static int subsequenceSpan(const QString &text, const QString &key);
+    static int substringScore(const Entry &entry, const QString &key);
+    static int fuzzyScore(const Entry &entry, const QString &key);
+    static int matchScore(const Entry &entry, const QString &key);
+
+    void appendResult(AppSearchResults &results, const Entry &entry, int score) const;
+
+    static void collectKeys(const QString &text, QSet<quint32> &bigrams, QSet<ushort> &chars);
+    template <typename Key>
+    static void insertPosting(QHash<Key, QVector<int> > &postings, Key key, int index);
+    template <typename Key>
+    static void removePosting(QHash<Key, QVector<int> > &postings, Key key, int index);
+
+    void insertEntry(const Entry &entry);
+    void addApp(const DataEntity &app);
+    void updateApp(const DataEntity &app);
+    void removeApp(const QString &appid);
+    void compact();
+    void rebuild();
+
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+
+private:
+    QVector<Entry> m_entries;
+    // appid -> m_entries中的位置
+    QHash<QString, int> m_entryIndexes;
+    // 二元组 -> 包含该二元组的条目，按条目位置升序
+    QHash<quint32, QVector<int> > m_bigrams;
+    // 字符 -> 包含该字符的条目，按条目位置升序
+    QHash<ushort, QVector<int> > m_chars;
+    // 已删除但还留在倒排表中的条目数量
+    int m_removedCount {0};
+    quint64 m_revision {0};
+};
+
+} // LingmoMenu
+
+#endif //LINGMO_MENU_APP_SEARCH_INDEX_H
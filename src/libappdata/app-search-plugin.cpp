@@ -20,13 +20,20 @@
 #include "app-search-plugin.h"
 #include "data-entity.h"
 #include "basic-app-model.h"
+#include "app-search-index.h"
 
 #include <LingmoSearchTask>
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
 #include <QTimer>
 #include <QAbstractListModel>
+#include <QAction>
 #include <QDebug>
 
+// 搜索结果合并插入模型的间隔，约为一帧(ms)
+#define SEARCH_RESULT_FLUSH_INTERVAL 16
+
 namespace LingmoMenu {
 
 // ====== AppSearchPluginPrivate ======
@@ -37,18 +44,25 @@ public:
     explicit AppSearchPluginPrivate(QObject *parent = nullptr);
 
 Q_SIGNALS:
-    void searchedOne(DataEntity app);
+    void searchedOne(DataEntity app, quint64 generation);
 
 public Q_SLOTS:
-    void startSearch(const QString &keyword);
+    void startSearch(const QString &keyword, quint64 generation);
     void stopSearch();
+    void shutdown();
 
 protected:
     void run() override;
 
 private:
     size_t m_searchId{0};
-    QTimer *m_timer{nullptr};
+    // 发起搜索时插件的搜索代数，随结果一起发送
+    quint64 m_generation{0};
+    bool m_searching{false};
+    // 结果队列中有新的数据，由搜索服务的通知设置，搜索线程取数据前清除
+    bool m_resultReady{false};
+    QMutex m_mutex;
+    QWaitCondition m_condition;
     LingmoSearch::LingmoSearchTask *m_appSearchTask {nullptr};
     LingmoSearch::DataQueue<LingmoSearch::ResultItem> *m_dataQueue{nullptr};
 };
@@ -64,12 +78,15 @@ AppSearchPluginPrivate::AppSearchPluginPrivate(QObject *parent) : QThread(parent
     searchResultProperties << LingmoSearch::SearchProperty::SearchResultProperty::ApplicationDesktopPath;
     m_appSearchTask->setResultProperties(LingmoSearch::SearchProperty::SearchType::Application, searchResultProperties);
 
-    m_timer = new QTimer;
-    m_timer->setInterval(3000);
-    m_timer->moveToThread(this);
+    // 搜索完成时唤醒搜索线程取出全部结果，通知来自搜索服务的线程
+    connect(m_appSearchTask, &LingmoSearch::LingmoSearchTask::searchFinished, this, [this] {
+        QMutexLocker locker(&m_mutex);
+        m_resultReady = true;
+        m_condition.wakeOne();
+    }, Qt::DirectConnection);
 }
 
-void AppSearchPluginPrivate::startSearch(const QString &keyword)
+void AppSearchPluginPrivate::startSearch(const QString &keyword, quint64 generation)
 {
     if (!this->isRunning()) {
         this->start();
@@ -77,39 +94,98 @@ void AppSearchPluginPrivate::startSearch(const QString &keyword)
 
     m_appSearchTask->clearKeyWords();
     m_appSearchTask->addKeyword(keyword);
-    m_searchId = m_appSearchTask->startSearch(LingmoSearch::SearchProperty::SearchType::Application);
+    size_t searchId = m_appSearchTask->startSearch(LingmoSearch::SearchProperty::SearchType::Application);
+
+    // 唤醒搜索线程开始接收结果
+    QMutexLocker locker(&m_mutex);
+    m_searchId = searchId;
+    m_generation = generation;
+    m_searching = true;
+    m_condition.wakeOne();
 }
 
 void AppSearchPluginPrivate::stopSearch()
 {
     m_appSearchTask->stop();
+
+    QMutexLocker locker(&m_mutex);
+    m_searching = false;
+}
+
+void AppSearchPluginPrivate::shutdown()
+{
+    stopSearch();
+
+    QMutexLocker locker(&m_mutex);
     this->requestInterruption();
+    m_condition.wakeOne();
 }
 
 void AppSearchPluginPrivate::run()
 {
-    while (!isInterruptionRequested()) {
-        LingmoSearch::ResultItem result = m_dataQueue->tryDequeue();
-        if(result.getSearchId() == 0 && result.getItemKey().isEmpty() && result.getAllValue().isEmpty()) {
-            if(!m_timer->isActive()) {
-                // 超时退出
-                m_timer->start();
+    size_t searchId = 0;
+    quint64 generation = 0;
+    bool searching = false;
+    // 搜索服务已返回结果，但startSearch还没有记录新的searchId
+    QVector<LingmoSearch::ResultItem> earlyResults;
+
+    auto handleResult = [&] (const LingmoSearch::ResultItem &result) {
+        if (!searching || result.getSearchId() != searchId) {
+            return;
+        }
+
+        DataEntity app;
+        QString id = result.getValue(LingmoSearch::SearchProperty::ApplicationDesktopPath).toString();
+        if (!BasicAppModel::instance()->getAppById(id, app)) {
+            BasicAppModel::instance()->databaseInterface()->getApp(id, app);
+        };
+        Q_EMIT this->searchedOne(app, generation);
+    };
+
+    while (true) {
+        {
+            // 在锁内检查条件后再等待，唤醒方也在锁内修改条件，检查与等待之间不会丢失唤醒
+            QMutexLocker locker(&m_mutex);
+            while (!isInterruptionRequested() && !m_resultReady && searchId == m_searchId) {
+                m_condition.wait(&m_mutex);
             }
-            msleep(100);
-        } else {
-            m_timer->stop();
-            if (result.getSearchId() == m_searchId) {
-                DataEntity app;
-                QString id = result.getValue(LingmoSearch::SearchProperty::ApplicationDesktopPath).toString();
-                if (!BasicAppModel::instance()->getAppById(id, app)) {
-                    BasicAppModel::instance()->databaseInterface()->getApp(id, app);
-                };
-                Q_EMIT this->searchedOne(app);
+
+            if (isInterruptionRequested()) {
+                break;
             }
+
+            m_resultReady = false;
+            searchId = m_searchId;
+            generation = m_generation;
+            searching = m_searching;
         }
 
-        if(m_timer->isActive() && m_timer->remainingTime() < 0.01 && m_dataQueue->isEmpty()) {
-            this->requestInterruption();
+        for (const auto &result : earlyResults) {
+            handleResult(result);
+        }
+        earlyResults.clear();
+
+        // 取出队列中的全部结果
+        while (!isInterruptionRequested()) {
+            LingmoSearch::ResultItem result = m_dataQueue->tryDequeue();
+            if(result.getSearchId() == 0 && result.getItemKey().isEmpty() && result.getAllValue().isEmpty()) {
+                break;
+            }
+
+            if (result.getSearchId() > searchId) {
+                QMutexLocker locker(&m_mutex);
+                if (result.getSearchId() != m_searchId) {
+                    // 等待startSearch记录新的searchId后处理
+                    earlyResults.append(result);
+                    continue;
+                }
+
+                searchId = m_searchId;
+                generation = m_generation;
+                searching = m_searching;
+            }
+
+            handleResult(result);
         }
     }
 }
@@ -119,26 +195,47 @@ class AppSearchModel : public QAbstractListModel
 {
     Q_OBJECT
 public:
+    enum SortMode {
+        Relevance = 0, /**> 按匹配分数排序，启动次数作为加分 */
+        Frequency,     /**> 按启动次数排序 */
+        Name           /**> 按名称排序 */
+    };
+
     explicit AppSearchModel(QObject *parent = nullptr);
     int rowCount(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
 
+    void setKeyword(const QString &keyword);
+    void setSortMode(SortMode mode);
     void appendApp(const DataEntity &app);
+    void setResults(const AppSearchResults &results);
     void clear();
+    const AppSearchResults &results() const;
 
 private:
-    QVector<DataEntity> m_apps;
+    void flush();
+    void sortResults(AppSearchResults &results) const;
+
+private:
+    QString m_keyword;
+    SortMode m_sortMode {Relevance};
+    AppSearchResults m_results;
+    // 等待插入模型的搜索结果
+    AppSearchResults m_pendingResults;
+    QTimer *m_flushTimer {nullptr};
 };
 
-AppSearchModel::AppSearchModel(QObject *parent) : QAbstractListModel(parent)
+AppSearchModel::AppSearchModel(QObject *parent) : QAbstractListModel(parent), m_flushTimer(new QTimer(this))
 {
-
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(SEARCH_RESULT_FLUSH_INTERVAL);
+    connect(m_flushTimer, &QTimer::timeout, this, &AppSearchModel::flush);
 }
 
 int AppSearchModel::rowCount(const QModelIndex &parent) const
 {
-    return m_apps.size();
+    return m_results.size();
 }
 
 int AppSearchModel::columnCount(const QModelIndex &parent) const
@@ -152,29 +249,151 @@ QVariant AppSearchModel::data(const QModelIndex &index, int role) const
         return {};
     }
 
-    const DataEntity &app = m_apps[index.row()];
+    const DataEntity &app = m_results[index.row()].app;
     return app.getValue(static_cast<DataEntity::PropertyName>(role));
 }
 
+void AppSearchModel::setKeyword(const QString &keyword)
+{
+    m_keyword = keyword.trimmed().toLower();
+}
+
+void AppSearchModel::setSortMode(SortMode mode)
+{
+    if (mode == m_sortMode) {
+        return;
+    }
+
+    m_sortMode = mode;
+    m_flushTimer->stop();
+
+    beginResetModel();
+    m_results.append(m_pendingResults);
+    m_pendingResults.clear();
+    sortResults(m_results);
+    endResetModel();
+}
+
 void AppSearchModel::appendApp(const DataEntity &app)
 {
-    beginInsertRows(QModelIndex(), m_apps.size(), m_apps.size());
-    m_apps.append(app);
-    endInsertRows();
+    // 合并一段时间内的结果，一次插入模型
+    AppSearchResult result;
+    result.app = app;
+    result.score = AppSearchIndex::score(app, m_keyword);
+    m_pendingResults.append(result);
+
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void AppSearchModel::setResults(const AppSearchResults &results)
+{
+    m_flushTimer->stop();
+    m_pendingResults.clear();
+
+    beginResetModel();
+    m_results = results;
+    sortResults(m_results);
+    endResetModel();
 }
 
 void AppSearchModel::clear()
 {
+    m_flushTimer->stop();
+    m_pendingResults.clear();
+
     beginResetModel();
-    m_apps.clear();
+    m_results.clear();
     endResetModel();
 }
 
+const AppSearchResults &AppSearchModel::results() const
+{
+    return m_results;
+}
+
+void AppSearchModel::flush()
+{
+    if (m_pendingResults.isEmpty()) {
+        return;
+    }
+
+    sortResults(m_pendingResults);
+
+    beginInsertRows(QModelIndex(), m_results.size(), m_results.size() + m_pendingResults.size() - 1);
+    m_results.append(m_pendingResults);
+    endInsertRows();
+
+    m_pendingResults.clear();
+}
+
+void AppSearchModel::sortResults(AppSearchResults &results) const
+{
+    if (m_sortMode == Name) {
+        std::stable_sort(results.begin(), results.end(), [] (const AppSearchResult &a, const AppSearchResult &b) {
+            return QString::compare(a.app.firstLetter(), b.app.firstLetter(), Qt::CaseInsensitive) < 0;
+        });
+        return;
+    }
+
+    // 先计算每个结果的排序值，避免比较时重复计算，数值越大越靠前
+    QVector<QPair<qint64, int> > keys;
+    keys.reserve(results.size());
+    for (int i = 0; i < results.size(); ++i) {
+        const AppSearchResult &result = results.at(i);
+        qint64 key;
+        if (m_sortMode == Frequency) {
+            qint64 launchTimes = result.app.launched() == 0 ? 0 : qMax(0, result.app.launchTimes());
+            key = (launchTimes << 32) | result.score;
+        } else {
+            key = result.score + AppSearchIndex::frecency(result.app);
+        }
+        keys.append({key, i});
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), [] (const QPair<qint64, int> &a, const QPair<qint64, int> &b) {
+        return a.first > b.first;
+    });
+
+    AppSearchResults sorted;
+    sorted.reserve(results.size());
+    for (const auto &key : keys) {
+        sorted.append(results.at(key.second));
+    }
+    results.swap(sorted);
+}
+
 // ====== AppSearchPlugin ====== //
 AppSearchPlugin::AppSearchPlugin(QObject *parent) : AppListPluginInterface(parent)
     , m_searchPluginPrivate(new AppSearchPluginPrivate(this)), m_model(new AppSearchModel(this))
+    , m_searchIndex(new AppSearchIndex(this))
 {
-    connect(m_searchPluginPrivate, &AppSearchPluginPrivate::searchedOne, m_model, &AppSearchModel::appendApp);
+    connect(m_searchPluginPrivate, &AppSearchPluginPrivate::searchedOne, this, &AppSearchPlugin::onSearchedOne);
+
+    auto relevanceAction = new QAction(QIcon::fromTheme("view-sort-descending-symbolic"), tr("Sort by relevance"), this);
+    auto frequencyAction = new QAction(QIcon::fromTheme("document-open-recent-symbolic"), tr("Sort by frequency"), this);
+    auto nameAction = new QAction(QIcon::fromTheme("lingmo-capslock-symbolic"), tr("Sort by name"), this);
+
+    relevanceAction->setData(AppSearchModel::Relevance);
+    frequencyAction->setData(AppSearchModel::Frequency);
+    nameAction->setData(AppSearchModel::Name);
+
+    m_actions.append(relevanceAction);
+    m_actions.append(frequencyAction);
+    m_actions.append(nameAction);
+
+    for (QAction *action : m_actions) {
+        action->setCheckable(true);
+        connect(action, &QAction::triggered, this, [this, action] {
+            m_model->setSortMode(static_cast<AppSearchModel::SortMode>(action->data().toInt()));
+            for (QAction *other : m_actions) {
+                other->setChecked(other == action);
+            }
+        });
+    }
+
+    relevanceAction->setChecked(true);
 }
 
 AppListPluginGroup::Group AppSearchPlugin::group()
@@ -189,13 +408,12 @@ QString AppSearchPlugin::name()
 
 QString AppSearchPlugin::title()
 {
-    return "Search";
+    return tr("Search");
 }
 
 QList<QAction *> AppSearchPlugin::actions()
 {
-    // TODO: 搜索结果排序选项
-    return {};
+    return m_actions;
 }
 
 QAbstractItemModel *AppSearchPlugin::dataModel()
@@ -205,17 +423,52 @@ QAbstractItemModel *AppSearchPlugin::dataModel()
 
 void AppSearchPlugin::search(const QString &keyword)
 {
-    m_model->clear();
-    if (keyword.isEmpty()) {
+    // 每次搜索更新代数，之前的搜索结果到达时直接丢弃
+    ++m_generation;
+
+    QString key = keyword.trimmed().toLower();
+    if (key.isEmpty()) {
+        m_lastKeyword.clear();
+        m_searchPluginPrivate->stopSearch();
+        m_model->clear();
+        return;
+    }
+
+    m_model->setKeyword(key);
+
+    // 关键字在上一次的基础上追加输入，且上一次是完整的本地结果时，直接在上一次的结果中筛选
+    AppSearchResults results;
+    if (!m_lastKeyword.isEmpty() && key.startsWith(m_lastKeyword) && m_lastRevision == m_searchIndex->revision()) {
+        results = m_searchIndex->refine(m_model->results(), key);
+    } else {
+        results = m_searchIndex->search(key);
+    }
+
+    m_model->setResults(results);
+
+    // 本地索引没有命中时再使用搜索服务查找，其结果不能用于筛选
+    if (results.isEmpty()) {
+        m_lastKeyword.clear();
+        m_searchPluginPrivate->startSearch(keyword, m_generation);
+    } else {
+        m_lastKeyword = key;
+        m_lastRevision = m_searchIndex->revision();
+        m_searchPluginPrivate->stopSearch();
+    }
+}
+
+void AppSearchPlugin::onSearchedOne(const DataEntity &app, quint64 generation)
+{
+    if (generation != m_generation) {
         return;
     }
 
-    m_searchPluginPrivate->startSearch(keyword);
+    m_model->appendApp(app);
 }
 
 AppSearchPlugin::~AppSearchPlugin()
 {
-    m_searchPluginPrivate->stopSearch();
+    m_searchPluginPrivate->shutdown();
     m_searchPluginPrivate->quit();
     m_searchPluginPrivate->wait();
     m_searchPluginPrivate->deleteLater();
@@ -22,15 +22,17 @@
 #define LINGMO_MENU_APP_SEARCH_PLUGIN_H
 
 #include "app-list-plugin.h"
+#include "data-entity.h"
 
 namespace LingmoMenu {
 
 class AppSearchPluginPrivate;
 class AppSearchModel;
+class AppSearchIndex;
 
 /**
  * @class AppSearchPlugin
- * 应用搜索插件，调用搜索接口进行应用搜索
+ * 应用搜索插件，优先使用本地索引搜索应用，本地没有结果时调用搜索接口
  */
 class AppSearchPlugin : public AppListPluginInterface
 {
@@ -46,8 +48,18 @@ public:
     QAbstractItemModel *dataModel() override;
     void search(const QString &keyword) override;
 
+private Q_SLOTS:
+    void onSearchedOne(const DataEntity &app, quint64 generation);
+
 private:
     AppSearchModel *m_model {nullptr};
+    AppSearchIndex *m_searchIndex {nullptr};
+    // 搜索代数，每次搜索递增
+    quint64 m_generation {0};
+    // 上一次完整的本地搜索结果对应的关键字和索引版本
+    QString m_lastKeyword;
+    quint64 m_lastRevision {0};
+    QList<QAction *> m_actions;
     AppSearchPluginPrivate * m_searchPluginPrivate {nullptr};
 };
 
@@ -19,9 +19,13 @@
  */
 
 #include "basic-app-model.h"
+#include "app-catalog-cache.h"
 #include "user-config.h"
 
 #include <QDebug>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
 
 namespace LingmoMenu {
 
@@ -36,15 +40,113 @@ BasicAppModel::BasicAppModel(QObject *parent) : QAbstractListModel(parent)
 {
     connect(m_databaseInterface, &AppDatabaseInterface::appDatabaseOpenFailed, this, [this] {
         qWarning() << "BasicAppModel: app database open failed.";
+        beginResetModel();
         m_apps.clear();
+        m_appIndex.clear();
+        endResetModel();
         // TODO: 显示错误信息到界面
     });
 
-    m_apps = m_databaseInterface->apps();
+    // 先使用上次保存的快照填充数据，数据库查询完成后再更新差异部分
+    m_loadedFromCache = AppCatalogCache::load(m_apps);
+    rebuildAppIndex();
+
+    // 数据变化后延迟写入快照，合并短时间内的多次变化
+    m_cacheTimer = new QTimer(this);
+    m_cacheTimer->setSingleShot(true);
+    m_cacheTimer->setInterval(3000);
+    connect(m_cacheTimer, &QTimer::timeout, this, [this] {
+        AppCatalogCache::save(m_apps);
+    });
+
+    // 应用数据在工作线程中查询，分批返回
+    m_databaseInterface->apps([this] (const DataEntityVector &apps, bool finished) {
+        onAppsLoaded(apps, finished);
+    });
 
     connect(m_databaseInterface, &AppDatabaseInterface::appAdded, this, &BasicAppModel::onAppAdded);
     connect(m_databaseInterface, &AppDatabaseInterface::appUpdated, this, &BasicAppModel::onAppUpdated);
     connect(m_databaseInterface, &AppDatabaseInterface::appDeleted, this, &BasicAppModel::onAppDeleted);
+
+    // 只在应用增删或应用本身的信息变化时更新快照，启动次数等状态的变化在下次启动时由数据库校正
+    connect(this, &BasicAppModel::rowsInserted, m_cacheTimer, QOverload<>::of(&QTimer::start));
+    connect(this, &BasicAppModel::rowsRemoved, m_cacheTimer, QOverload<>::of(&QTimer::start));
+    connect(this, &BasicAppModel::modelReset, m_cacheTimer, QOverload<>::of(&QTimer::start));
+    connect(this, &BasicAppModel::dataChanged, this, [this] (const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+        if (roles.isEmpty() || roles.contains(DataEntity::Name) || roles.contains(DataEntity::Icon)
+            || roles.contains(DataEntity::Category) || roles.contains(DataEntity::FirstLetter)
+            || roles.contains(DataEntity::InstallationTime)) {
+            m_cacheTimer->start();
+        }
+    });
+}
+
+void BasicAppModel::onAppsLoaded(const DataEntityVector &apps, bool finished)
+{
+    if (!m_loadedFromCache) {
+        // 没有快照时直接分批插入
+        onAppAdded(apps);
+        return;
+    }
+
+    m_pendingApps.append(apps);
+    if (finished) {
+        DataEntityVector databaseApps;
+        databaseApps.swap(m_pendingApps);
+        m_loadedFromCache = false;
+        // 数据库打开失败或查询出错时结果为空，此时保留快照，不能当作全部应用已被卸载
+        if (databaseApps.isEmpty()) {
+            qWarning() << "BasicAppModel: app database returned no apps, keep the snapshot.";
+            return;
+        }
+        reconcileApps(databaseApps);
+    }
+}
+
+/**
+ * 对比快照与数据库中的应用，只对有差异的应用发送信号
+ * @param apps 数据库中的全部应用
+ */
+void BasicAppModel::reconcileApps(const DataEntityVector &apps)
+{
+    QSet<QString> databaseIds;
+    DataEntityVector addedApps;
+    QVector<QPair<DataEntity, QVector<int> > > updates;
+
+    for (const auto &app : apps) {
+        databaseIds.insert(app.id());
+
+        int row = indexOfApp(app.id());
+        if (row < 0) {
+            addedApps.append(app);
+        } else if (!AppCatalogCache::isSameApp(m_apps.at(row), app)) {
+            updates.append({app, {}});
+        }
+    }
+
+    QStringList removedApps;
+    for (const auto &app : m_apps) {
+        if (!databaseIds.contains(app.id())) {
+            removedApps.append(app.id());
+        }
+    }
+
+    beginBatch();
+    if (!removedApps.isEmpty()) {
+        // 快照中过期的应用只从列表中移除，不是卸载操作，不修改用户配置
+        removeApps(removedApps);
+    }
+
+    if (!updates.isEmpty()) {
+        onAppUpdated(updates);
+        // 在同一批修改中写入，不等待下一轮事件循环
+        flushChangedApps();
+    }
+
+    if (!addedApps.isEmpty()) {
+        onAppAdded(addedApps);
+    }
+    commitBatch();
 }
 
 int BasicAppModel::rowCount(const QModelIndex &parent) const
@@ -121,36 +223,141 @@ const AppDatabaseInterface *BasicAppModel::databaseInterface() const
 void BasicAppModel::onAppAdded(const DataEntityVector &apps)
 {
     DataEntityVector appItems;
+    QSet<QString> newIds;
     for (auto const & app : apps) {
-        if (indexOfApp(app.id()) < 0) {
-            appItems.append(app);
+        if (app.id().isEmpty() || m_appIndex.contains(app.id()) || newIds.contains(app.id())) {
+            continue;
         }
+
+        newIds.insert(app.id());
+        appItems.append(app);
     }
     if (appItems.isEmpty()) return;
-    beginInsertRows(QModelIndex(), m_apps.size(), m_apps.size() + appItems.size() - 1);
+    // 只发送一次插入信号，不需要批量修改，上层model直接将新的行插入到排序位置
+    int first = m_apps.size();
+    beginInsertRows(QModelIndex(), first, first + appItems.size() - 1);
     m_apps.append(appItems);
+    rebuildAppIndex(first);
     endInsertRows();
 }
 
 void BasicAppModel::onAppUpdated(const QVector<QPair<DataEntity, QVector<int> > > &updates)
 {
     for (const auto &pair : updates) {
-        int index = indexOfApp(pair.first.id());
-        if (index < 0) {
+        if (indexOfApp(pair.first.id()) < 0) {
             continue;
         }
 
-        DataEntity &app = m_apps[index];
-        QVector<int> roles = pair.second;
-        if (!roles.isEmpty()) {
+        queueAppUpdate(pair.first, pair.second);
+    }
+}
+
+/**
+ * 暂存应用的新数据，在本轮事件循环结束时与dataChanged信号一起写入
+ * 写入之前model中仍然是旧数据，上层model读到的数据与其排序和过滤状态保持一致
+ * @param app 新的应用数据
+ * @param roles 变化的属性，为空表示全部属性
+ */
+void BasicAppModel::queueAppUpdate(const DataEntity &app, const QVector<int> &roles)
+{
+    auto it = m_pendingUpdates.find(app.id());
+    if (it == m_pendingUpdates.end()) {
+        m_pendingUpdates.insert(app.id(), {app, roles});
+    } else if (roles.isEmpty()) {
+        it.value() = {app, roles};
+    } else {
+        // 合并多次部分更新，之前为全部属性时仍然更新全部属性
+        DataEntity &pendingApp = it.value().first;
+        QVector<int> &pendingRoles = it.value().second;
+        for (const auto &role : roles) {
+            pendingApp.setValue(static_cast<DataEntity::PropertyName>(role), app.getValue(static_cast<DataEntity::PropertyName>(role)));
+        }
+
+        if (!pendingRoles.isEmpty()) {
+            for (const auto &role : roles) {
+                if (!pendingRoles.contains(role)) {
+                    pendingRoles.append(role);
+                }
+            }
+        }
+    }
+
+    if (!m_changeFlushPending) {
+        m_changeFlushPending = true;
+        QMetaObject::invokeMethod(this, &BasicAppModel::flushChangedApps, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * 写入暂存的应用数据，将变化属性相同的连续行合并为一个区间，每个区间只发送一次dataChanged信号
+ * 每个区间的数据在发送其信号前才写入，上层model处理信号时不会读到尚未通知的变化
+ */
+void BasicAppModel::flushChangedApps()
+{
+    m_changeFlushPending = false;
+    if (m_pendingUpdates.isEmpty()) {
+        return;
+    }
+
+    struct PendingRow {
+        int row;
+        DataEntity app;
+        QVector<int> roles;
+    };
+
+    QVector<PendingRow> rows;
+    rows.reserve(m_pendingUpdates.size());
+    for (auto it = m_pendingUpdates.constBegin(); it != m_pendingUpdates.constEnd(); ++it) {
+        int row = indexOfApp(it.key());
+        if (row >= 0) {
+            // 属性排序后再比较，相同的属性集合才能合并
+            QVector<int> roles = it.value().second;
+            std::sort(roles.begin(), roles.end());
+            rows.append({row, it.value().first, roles});
+        }
+    }
+    m_pendingUpdates.clear();
+
+    std::sort(rows.begin(), rows.end(), [] (const PendingRow &a, const PendingRow &b) {
+        return a.row < b.row;
+    });
+
+    // 只有一个应用变化时不需要批量修改，上层model直接调整这一行
+    bool batch = rows.size() > 1;
+    if (batch) {
+        beginBatch();
+    }
+
+    int i = 0;
+    while (i < rows.size()) {
+        // 只合并变化属性完全相同的连续行，不同的行各自发送信号，不会把部分更新扩大为全部更新
+        int first = i;
+        int last = i;
+        while (last + 1 < rows.size() && rows.at(last + 1).row == rows.at(last).row + 1
+               && rows.at(last + 1).roles == rows.at(first).roles) {
+            ++last;
+        }
+        i = last + 1;
+
+        const QVector<int> &roles = rows.at(first).roles;
+        for (int j = first; j <= last; ++j) {
+            const PendingRow &pending = rows.at(j);
+            DataEntity &app = m_apps[pending.row];
+            if (roles.isEmpty()) {
+                app = pending.app;
+                continue;
+            }
+
             for (const auto &role : roles) {
-                app.setValue(static_cast<DataEntity::PropertyName>(role), pair.first.getValue(static_cast<DataEntity::PropertyName>(role)));
+                app.setValue(static_cast<DataEntity::PropertyName>(role), pending.app.getValue(static_cast<DataEntity::PropertyName>(role)));
             }
-        } else {
-            app = pair.first;
         }
 
-        dataChanged(QAbstractListModel::index(index), QAbstractListModel::index(index), roles);
+        Q_EMIT dataChanged(QAbstractListModel::index(rows.at(first).row), QAbstractListModel::index(rows.at(last).row), roles);
+    }
+
+    if (batch) {
+        commitBatch();
     }
 }
 
@@ -158,32 +365,107 @@ void BasicAppModel::onAppDeleted(const QStringList &apps)
 {
     for (const auto &appid : apps) {
         UserConfig::instance()->removePreInstalledApp(appid);
+    }
+    removeApps(apps);
+}
+
+void BasicAppModel::removeApps(const QStringList &apps)
+{
+    QVector<int> rows;
+    for (const auto &appid : apps) {
         int index = indexOfApp(appid);
-        if (index < 0) {
-            continue;
+        if (index >= 0) {
+            rows.append(index);
+        }
+    }
+
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // 从后向前删除，每段连续的行只发送一次删除信号，且不影响前面的行号
+    // 同时删除多个应用时(如卸载软件包)作为一次批量修改
+    bool batch = rows.size() > 1;
+    if (batch) {
+        beginBatch();
+    }
+
+    int last = rows.size() - 1;
+    while (last >= 0) {
+        int first = last;
+        while (first > 0 && rows.at(first - 1) == rows.at(first) - 1) {
+            --first;
         }
 
-        beginRemoveRows(QModelIndex(), index, index);
-        m_apps.takeAt(index);
+        int firstRow = rows.at(first);
+        int count = rows.at(last) - firstRow + 1;
+
+        beginRemoveRows(QModelIndex(), firstRow, firstRow + count - 1);
+        for (int row = firstRow; row < firstRow + count; ++row) {
+            m_appIndex.remove(m_apps.at(row).id());
+        }
+        m_apps.remove(firstRow, count);
+        rebuildAppIndex(firstRow);
         endRemoveRows();
+
+        last = first - 1;
+    }
+
+    if (batch) {
+        commitBatch();
+    }
+}
+
+void BasicAppModel::beginBatch()
+{
+    if (m_batchDepth++ == 0) {
+        Q_EMIT batchBegun();
+    }
+}
+
+void BasicAppModel::commitBatch()
+{
+    if (m_batchDepth <= 0) {
+        return;
+    }
+
+    if (--m_batchDepth == 0) {
+        Q_EMIT batchCommitted();
     }
 }
 
+bool BasicAppModel::isInBatch() const
+{
+    return m_batchDepth > 0;
+}
+
 int BasicAppModel::indexOfApp(const QString &appid) const
 {
     if (appid.isEmpty()) {
         return -1;
     }
 
-    auto it = std::find_if(m_apps.constBegin(), m_apps.constEnd(), [&appid] (const DataEntity &app) {
-        return app.id() == appid;
-    });
+    return m_appIndex.value(appid, -1);
+}
 
-    if (it == m_apps.constEnd()) {
-        return -1;
+/**
+ * 重新计算从first行开始的所有应用的行号
+ * @param first 起始行，在其之前的行号保持不变
+ */
+void BasicAppModel::rebuildAppIndex(int first)
+{
+    if (first <= 0) {
+        m_appIndex.clear();
+        m_appIndex.reserve(m_apps.size());
+        first = 0;
     }
 
-    return std::distance(m_apps.constBegin(), it);
+    for (int row = first; row < m_apps.size(); ++row) {
+        m_appIndex.insert(m_apps.at(row).id(), row);
+    }
 }
 
 DataEntity BasicAppModel::appOfIndex(int row) const
@@ -23,10 +23,13 @@
 
 #include <QAbstractListModel>
 #include <QVector>
+#include <QHash>
 
 #include "data-entity.h"
 #include "app-database-interface.h"
 
+class QTimer;
+
 namespace LingmoMenu {
 
 class BasicAppModel : public QAbstractListModel
@@ -44,12 +47,24 @@ public:
     int indexOfApp(const QString &appid) const;
     bool getAppById(const QString &appid, DataEntity &app) const;
 
+    /**
+     * 批量修改数据，用于同时修改多个应用的情况(如快照对比、批量删除)，支持嵌套调用
+     * beginBatch与commitBatch之间上层model可以推迟排序和过滤，commitBatch时只对受影响的部分统一处理一次
+     */
+    void beginBatch();
+    void commitBatch();
+    bool isInBatch() const;
+
     int rowCount(const QModelIndex &parent) const override;
     int columnCount(const QModelIndex &parent) const override;
     QVariant data(const QModelIndex &index, int role) const override;
     bool setData(const QModelIndex &index, const QVariant &value, int role) override;
     QHash<int, QByteArray> roleNames() const override;
 
+Q_SIGNALS:
+    void batchBegun();
+    void batchCommitted();
+
 private Q_SLOTS:
     void onAppAdded(const LingmoMenu::DataEntityVector &apps);
     void onAppUpdated(const QVector<QPair<LingmoMenu::DataEntity, QVector<int> > > &updates);
@@ -57,9 +72,26 @@ private Q_SLOTS:
 
 private:
     explicit BasicAppModel(QObject *parent = nullptr);
+    void rebuildAppIndex(int first = 0);
+    void onAppsLoaded(const DataEntityVector &apps, bool finished);
+    void reconcileApps(const DataEntityVector &apps);
+    void removeApps(const QStringList &apps);
+    void queueAppUpdate(const DataEntity &app, const QVector<int> &roles);
+    void flushChangedApps();
+
     AppDatabaseInterface *m_databaseInterface {nullptr};
+    // 数据来自本地快照时，需要等待数据库的完整结果进行对比
+    bool m_loadedFromCache {false};
+    DataEntityVector m_pendingApps;
+    QTimer *m_cacheTimer {nullptr};
+    // 等待写入并发送dataChanged信号的应用数据及其变化的属性
+    QHash<QString, QPair<DataEntity, QVector<int> > > m_pendingUpdates;
+    bool m_changeFlushPending {false};
+    int m_batchDepth {0};
 
     QVector<DataEntity> m_apps;
+    // appid -> m_apps中的行号，随m_apps的增删同步维护
+    QHash<QString, int> m_appIndex;
 };
 
 } // LingmoMenu
@@ -21,6 +21,7 @@
 #include "combined-list-model.h"
 
 #include <QDebug>
+#include <algorithm>
 
 namespace LingmoMenu {
 
@@ -36,17 +37,14 @@ QModelIndex CombinedListModel::index(int row, int column, const QModelIndex &par
         return {};
     }
 
-    int start = 0;
-    for (const auto &pair : m_subModels) {
-        int rc = pair.second;
-        if (row < (start + rc)) {
-            return createIndex(row, 0, pair.first);
-        } else {
-            start += rc;
-        }
+    // 二分查找row所在的subModel
+    auto it = std::upper_bound(m_offsets.constBegin(), m_offsets.constEnd(), row);
+    int i = int(it - m_offsets.constBegin()) - 1;
+    if (i < 0 || i >= m_subModels.size()) {
+        return {};
     }
 
-    return {};
+    return createIndex(row, 0, m_subModels.at(i).first);
 }
 
 QModelIndex CombinedListModel::parent(const QModelIndex &child) const
@@ -56,12 +54,7 @@ QModelIndex CombinedListModel::parent(const QModelIndex &child) const
 
 int CombinedListModel::rowCount(const QModelIndex &parent) const
 {
-    int count = 0;
-    for (const auto &pair : m_subModels) {
-        count += pair.second;
-    }
-
-    return count;
+    return m_offsets.last();
 }
 
 int CombinedListModel::columnCount(const QModelIndex &parent) const
@@ -104,23 +97,39 @@ QModelIndex CombinedListModel::mapFromSource(const QModelIndex &sourceIndex) con
         return {};
     }
 
-    return createIndex(offset + sourceIndex.row(), 0);
+    return createIndex(offset + sourceIndex.row(), 0, const_cast<QAbstractItemModel*>(sourceIndex.model()));
 }
 
 int CombinedListModel::offsetOfSubModel(const QAbstractItemModel *subModel) const
 {
-    int offset = 0;
-    for (const auto &pair : m_subModels) {
-        if (pair.first == subModel) {
-            return offset;
-        } else {
-            offset += pair.second;
+    for (int i = 0; i < m_subModels.size(); ++i) {
+        if (m_subModels.at(i).first == subModel) {
+            return m_offsets.at(i);
         }
     }
 
     return -1;
 }
 
+void CombinedListModel::updateOffsets(int from)
+{
+    m_offsets.resize(m_subModels.size() + 1);
+    for (int i = qMax(0, from); i < m_subModels.size(); ++i) {
+        m_offsets[i + 1] = m_offsets.at(i) + m_subModels.at(i).second;
+    }
+}
+
+void CombinedListModel::setSubModelRowCount(const QAbstractItemModel *subModel, int rowCount)
+{
+    for (int i = 0; i < m_subModels.size(); ++i) {
+        if (m_subModels.at(i).first == subModel) {
+            m_subModels[i].second = rowCount;
+            updateOffsets(i);
+            return;
+        }
+    }
+}
+
 QVariant CombinedListModel::data(const QModelIndex &proxyIndex, int role) const
 {
     if (!checkIndex(proxyIndex, CheckIndexOption::IndexIsValid)) {
@@ -162,6 +171,7 @@ void CombinedListModel::insertSubModel(QAbstractItemModel *subModel, int index)
     } else {
         m_subModels.insert(index, {subModel, subModel->rowCount()});
     }
+    updateOffsets();
 
     // 在删除前通知上层model进行处理
     connect(subModel, &QAbstractItemModel::rowsAboutToBeRemoved,
@@ -169,12 +179,7 @@ void CombinedListModel::insertSubModel(QAbstractItemModel *subModel, int index)
             int offset = offsetOfSubModel(subModel);
             if (offset >= 0) {
                 beginRemoveRows(mapFromSource(parent), offset + first, offset + last);
-                for (auto &pair : m_subModels) {
-                    if (pair.first == subModel) {
-//                        pair.second = subModel->rowCount();
-                        pair.second = pair.second - (last - first + 1);
-                    }
-                }
+                setSubModelRowCount(subModel, m_subModels.at(indexOfSubModel(subModel)).second - (last - first + 1));
                 endRemoveRows();
             }
     });
@@ -184,12 +189,7 @@ void CombinedListModel::insertSubModel(QAbstractItemModel *subModel, int index)
             int offset = offsetOfSubModel(subModel);
             if (offset >= 0) {
                 beginInsertRows(mapFromSource(parent), offset + first, offset + last);
-                for (auto &pair : m_subModels) {
-                    if (pair.first == subModel) {
-//                        pair.second = subModel->rowCount();
-                        pair.second = pair.second + (last - first + 1);
-                    }
-                }
+                setSubModelRowCount(subModel, m_subModels.at(indexOfSubModel(subModel)).second + (last - first + 1));
                 endInsertRows();
             }
     });
@@ -199,24 +199,34 @@ void CombinedListModel::insertSubModel(QAbstractItemModel *subModel, int index)
         Q_EMIT dataChanged( mapFromSource(topLeft),  mapFromSource(bottomRight), roles);
     });
 
-    connect(subModel, &QAbstractItemModel::modelReset, this, [subModel, this] {
-        beginResetModel();
-        for (auto &pair : m_subModels) {
-            if (pair.first == subModel) {
-                pair.second = pair.second;
-            }
+    // subModel重置时只替换其对应的行，不影响其他subModel
+    connect(subModel, &QAbstractItemModel::modelAboutToBeReset, this, [subModel, this] {
+        int i = indexOfSubModel(subModel);
+        int count = (i < 0) ? 0 : m_subModels.at(i).second;
+        if (count > 0) {
+            int offset = m_offsets.at(i);
+            beginRemoveRows(QModelIndex(), offset, offset + count - 1);
+            setSubModelRowCount(subModel, 0);
+            endRemoveRows();
         }
-        endResetModel();
     });
 
-    connect(subModel, &QAbstractItemModel::layoutAboutToBeChanged, this, [this] {
-        emit layoutAboutToBeChanged();
+    connect(subModel, &QAbstractItemModel::modelReset, this, [subModel, this] {
+        int offset = offsetOfSubModel(subModel);
+        int count = subModel->rowCount();
+        if (offset >= 0 && count > 0) {
+            beginInsertRows(QModelIndex(), offset, offset + count - 1);
+            setSubModelRowCount(subModel, count);
+            endInsertRows();
+        }
     });
 
-    connect(subModel, &QAbstractItemModel::layoutChanged, this, [this] {
-        emit layoutChanged();
+    connect(subModel, &QAbstractItemModel::layoutAboutToBeChanged, this, [subModel, this] {
+        onSubModelLayoutAboutToBeChanged(subModel);
     });
 
+    connect(subModel, &QAbstractItemModel::layoutChanged, this, &CombinedListModel::onSubModelLayoutChanged);
+
     endResetModel();
 }
 
@@ -229,10 +239,17 @@ void CombinedListModel::removeSubModel(int index)
     QPair<QAbstractItemModel*, int> pair = m_subModels[index];
     int offset = offsetOfSubModel(pair.first);
 
-    beginRemoveRows(QModelIndex(), offset, offset + pair.second);
+    if (pair.second > 0) {
+        beginRemoveRows(QModelIndex(), offset, offset + pair.second - 1);
+    }
+
     pair = m_subModels.takeAt(index);
     disconnect(pair.first, nullptr, this, nullptr);
-    endRemoveRows();
+    updateOffsets(index);
+
+    if (pair.second > 0) {
+        endRemoveRows();
+    }
 }
 
 void CombinedListModel::removeSubModel(QAbstractItemModel *subModel)
@@ -240,6 +257,38 @@ void CombinedListModel::removeSubModel(QAbstractItemModel *subModel)
     removeSubModel(indexOfSubModel(subModel));
 }
 
+/**
+ * subModel的布局变化只影响其对应的行，记录这些行的持久化索引在subModel中的位置，布局变化后重新映射
+ */
+void CombinedListModel::onSubModelLayoutAboutToBeChanged(QAbstractItemModel *subModel)
+{
+    Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+
+    m_layoutChangeIndexes.clear();
+    m_layoutChangeSourceIndexes.clear();
+    for (const auto &index : persistentIndexList()) {
+        if (index.internalPointer() == subModel) {
+            m_layoutChangeIndexes.append(index);
+            m_layoutChangeSourceIndexes.append(QPersistentModelIndex(mapToSource(index)));
+        }
+    }
+}
+
+void CombinedListModel::onSubModelLayoutChanged()
+{
+    QModelIndexList newIndexes;
+    newIndexes.reserve(m_layoutChangeSourceIndexes.size());
+    for (const auto &sourceIndex : m_layoutChangeSourceIndexes) {
+        newIndexes.append(mapFromSource(sourceIndex));
+    }
+
+    changePersistentIndexList(m_layoutChangeIndexes, newIndexes);
+    m_layoutChangeIndexes.clear();
+    m_layoutChangeSourceIndexes.clear();
+
+    Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
 int CombinedListModel::indexOfSubModel(QAbstractItemModel *subModel)
 {
     for (int i = 0; i < m_subModels.size(); ++i) {
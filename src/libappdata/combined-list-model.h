@@ -22,6 +22,7 @@
 #define LINGMO_MENU_COMBINED_LIST_MODEL_H
 
 #include <QAbstractListModel>
+#include <QPersistentModelIndex>
 #include <QVector>
 #include <QPair>
 
@@ -69,9 +70,19 @@ public:
 
 private:
     int offsetOfSubModel(const QAbstractItemModel *subModel) const;
+    void updateOffsets(int from = 0);
+    void setSubModelRowCount(const QAbstractItemModel *subModel, int rowCount);
+    void onSubModelLayoutAboutToBeChanged(QAbstractItemModel *subModel);
+    void onSubModelLayoutChanged();
 
 private:
     QVector<QPair<QAbstractItemModel*, int> > m_subModels;
+    // 每个subModel的起始行，最后一个元素为总行数
+    QVector<int> m_offsets {0};
+
+    // 布局变化前属于该subModel的持久化索引和对应的subModel索引，只在布局变化期间存在
+    QModelIndexList m_layoutChangeIndexes;
+    QVector<QPersistentModelIndex> m_layoutChangeSourceIndexes;
 };
 
 } // LingmoMenu
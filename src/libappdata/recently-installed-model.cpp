@@ -25,7 +25,11 @@
 #include <QDebug>
 #include <QTimer>
 #include <QDateTime>
-#include <QTimerEvent>
+
+// 最近安装的有效期为30天
+#define RECENTLY_INSTALLED_DURATION (30 * 24 * 3600)
+// QTimer的间隔不能超过int范围，超过一天时分段等待
+#define RECENTLY_INSTALLED_MAX_INTERVAL (24 * 3600)
 
 namespace LingmoMenu {
 
@@ -37,9 +41,86 @@ RecentlyInstalledModel::RecentlyInstalledModel(QObject *parent) : QSortFilterPro
 //    QSortFilterProxyModel::sort(0, Qt::DescendingOrder);
     QSortFilterProxyModel::sort(0);
 
-    // 每48小时主动刷新
-    m_timer->setInterval(48 * 3600000);
-    m_timer->start();
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &RecentlyInstalledModel::onExpiryTimeout);
+
+    // 批量修改期间有应用插入时暂停动态排序，提交时统一排序一次
+    // 没有插入的批量修改不影响动态排序，数据变化由QSortFilterProxyModel逐行处理
+    connect(BasicAppModel::instance(), &BasicAppModel::rowsAboutToBeInserted, this, [this] {
+        if (BasicAppModel::instance()->isInBatch() && dynamicSortFilter()) {
+            setDynamicSortFilter(false);
+        }
+    });
+    connect(BasicAppModel::instance(), &BasicAppModel::dataChanged, this, &RecentlyInstalledModel::onSourceDataChanged);
+    connect(BasicAppModel::instance(), &BasicAppModel::batchCommitted, this, &RecentlyInstalledModel::onSourceBatchCommitted);
+
+    connect(this, &RecentlyInstalledModel::rowsInserted, this, &RecentlyInstalledModel::updateExpiryTimer);
+    connect(this, &RecentlyInstalledModel::rowsRemoved, this, &RecentlyInstalledModel::updateExpiryTimer);
+    connect(this, &RecentlyInstalledModel::layoutChanged, this, &RecentlyInstalledModel::updateExpiryTimer);
+    connect(this, &RecentlyInstalledModel::modelReset, this, &RecentlyInstalledModel::updateExpiryTimer);
+    updateExpiryTimer();
+}
+
+void RecentlyInstalledModel::updateExpiryTimer()
+{
+    int count = rowCount();
+    if (count == 0) {
+        m_timer->stop();
+        return;
+    }
+
+    // 按安装时间降序排列，最后一行最早过期
+    qint64 installTime = index(count - 1, 0).data(DataEntity::InstallTimestamp).toLongLong();
+    qint64 remaining = installTime + RECENTLY_INSTALLED_DURATION + 1 - QDateTime::currentSecsSinceEpoch();
+    remaining = qBound<qint64>(0, remaining, RECENTLY_INSTALLED_MAX_INTERVAL);
+
+    m_timer->start(int(remaining * 1000));
+}
+
+void RecentlyInstalledModel::onExpiryTimeout()
+{
+    int count = rowCount();
+    if (count == 0) {
+        return;
+    }
+
+    qint64 installTime = index(count - 1, 0).data(DataEntity::InstallTimestamp).toLongLong();
+    if (QDateTime::currentSecsSinceEpoch() - installTime > RECENTLY_INSTALLED_DURATION) {
+        // 重新过滤后，已过期的应用被移除，并重新设置定时器
+        // QSortFilterProxyModel没有移除单行的接口，这里会重新过滤全部应用，但每个应用过期时只触发一次
+        invalidateFilter();
+    }
+
+    updateExpiryTimer();
+}
+
+void RecentlyInstalledModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    Q_UNUSED(topLeft)
+    Q_UNUSED(bottomRight)
+    // 暂停动态排序时QSortFilterProxyModel不会重新过滤变化的行，记录下来在提交时处理
+    if (dynamicSortFilter()) {
+        return;
+    }
+
+    if (roles.isEmpty() || roles.contains(DataEntity::Id) || roles.contains(DataEntity::IsLaunched)
+        || roles.contains(DataEntity::Favorite) || roles.contains(DataEntity::InstallationTime)
+        || roles.contains(DataEntity::InstallTimestamp)) {
+        m_filterPending = true;
+    }
+}
+
+void RecentlyInstalledModel::onSourceBatchCommitted()
+{
+    if (!dynamicSortFilter()) {
+        // 恢复动态排序时会对已有的行排序一次，包括批量修改期间插入的行
+        setDynamicSortFilter(true);
+    }
+
+    if (m_filterPending) {
+        m_filterPending = false;
+        invalidateFilter();
+    }
 }
 
 bool RecentlyInstalledModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
@@ -59,23 +140,19 @@ bool RecentlyInstalledModel::filterAcceptsRow(int source_row, const QModelIndex
         return false;
     }
 
-    QDateTime installDate = QDateTime::fromString(sourceIndex.data(DataEntity::InstallationTime).value<QString>(), "yyyy-MM-dd hh:mm:ss");
-    if (!installDate.isValid()) {
+    qint64 installTime = sourceIndex.data(DataEntity::InstallTimestamp).toLongLong();
+    if (installTime <= 0) {
         return false;
     }
 
-    QDateTime currentDateTime = QDateTime::currentDateTime();
     // 安装时间在30天内
-    qint64 xt = currentDateTime.toSecsSinceEpoch() - installDate.toSecsSinceEpoch();
-    return (xt >= 0) && (xt <= 30 * 24 * 3600);
+    qint64 xt = QDateTime::currentSecsSinceEpoch() - installTime;
+    return (xt >= 0) && (xt <= RECENTLY_INSTALLED_DURATION);
 }
 
 bool RecentlyInstalledModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
 {
-    QDateTime leftInstallDate = QDateTime::fromString(source_left.data(DataEntity::InstallationTime).value<QString>(), "yyyy-MM-dd hh:mm:ss");
-    QDateTime rightInstallDate = QDateTime::fromString(source_right.data(DataEntity::InstallationTime).value<QString>(), "yyyy-MM-dd hh:mm:ss");
-
-    qint64 xt = leftInstallDate.toSecsSinceEpoch() - rightInstallDate.toSecsSinceEpoch();
+    qint64 xt = source_left.data(DataEntity::InstallTimestamp).toLongLong() - source_right.data(DataEntity::InstallTimestamp).toLongLong();
     if (xt == 0) {
         return source_left.data(DataEntity::FirstLetter).value<QString>() < source_right.data(DataEntity::FirstLetter).value<QString>();
     }
@@ -83,19 +160,6 @@ bool RecentlyInstalledModel::lessThan(const QModelIndex &source_left, const QMod
     return xt >= 0;
 }
 
-bool RecentlyInstalledModel::event(QEvent *event)
-{
-    if (event->type() == QEvent::Timer) {
-        auto timerEvent = static_cast<QTimerEvent*>(event);
-        if (timerEvent->timerId() == m_timer->timerId()) {
-            invalidate();
-            return true;
-        }
-    }
-
-    return QObject::event(event);
-}
-
 QVariant RecentlyInstalledModel::data(const QModelIndex &index, int role) const
 {
     if (role == DataEntity::Group) {
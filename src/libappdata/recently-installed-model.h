@@ -32,7 +32,6 @@ class RecentlyInstalledModel : public QSortFilterProxyModel
     Q_OBJECT
 public:
     explicit RecentlyInstalledModel(QObject *parent = nullptr);
-    bool event(QEvent *event) override;
 
     QVariant data(const QModelIndex &index, int role) const override;
 
@@ -41,7 +40,16 @@ protected:
     bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const override;
 
 private:
+    void updateExpiryTimer();
+    void onExpiryTimeout();
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onSourceBatchCommitted();
+
+private:
+    // 在最早过期的应用到期时触发
     QTimer *m_timer {nullptr};
+    // 暂停动态排序期间有影响过滤结果的数据变化
+    bool m_filterPending {false};
 };
 
 } // LingmoMenu
@@ -0,0 +1,702 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fake-app-database.h"
+#include "benchmark-report.h"
+#include "basic-app-model.h"
+#include "app-category-plugin.h"
+#include "app-list-model.h"
+#include "app-group-model.h"
+#include "app-search-index.h"
+#include "app-search-plugin.h"
+#include "favorite/app-favorite-model.h"
+#include "favorite/favorites-model.h"
+#include "favorite/favorites-config.h"
+
+#include <QtTest>
+#include <QApplication>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QAction>
+#include <QDir>
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// 临时用户目录，测试进程只读写该目录下的配置和快照
+#define BENCHMARK_SANDBOX_ENV "LINGMO_MENU_BENCHMARK_SANDBOX"
+// 结果文件路径，默认为当前目录下的 app-data-benchmark-<应用数量>.json
+#define BENCHMARK_OUTPUT_ENV "LINGMO_MENU_BENCHMARK_OUTPUT"
+// 单次操作的重复次数
+#define BENCHMARK_ITERATIONS 20
+// 一次安装的应用数量
+#define BENCHMARK_BURST_SIZE 500
+// 逐个安装的应用数量和收藏的应用数量
+#define BENCHMARK_STORM_SIZE 1000
+#define BENCHMARK_FAVORITE_COUNT 50
+// 按安装时间排序的应用数量
+#define BENCHMARK_SORT_SIZE 5000
+// 加载超时(ms)
+#define BENCHMARK_LOAD_TIMEOUT 60000
+
+using namespace LingmoMenu;
+
+/**
+ * @class GroupSourceModel
+ *
+ * 只提供Group属性的列表，作为AppGroupModel单独测试时的source model
+ */
+class GroupSourceModel : public QAbstractListModel
+{
+public:
+    int rowCount(const QModelIndex &parent) const override
+    {
+        return parent.isValid() ? 0 : m_groups.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!checkIndex(index, CheckIndexOption::IndexIsValid) || role != DataEntity::Group) {
+            return {};
+        }
+        return m_groups.at(index.row());
+    }
+
+    void appendRows(const QString &group, int count)
+    {
+        beginInsertRows(QModelIndex(), m_groups.size(), m_groups.size() + count - 1);
+        m_groups.insert(m_groups.size(), count, group);
+        endInsertRows();
+    }
+
+    void insertGroupRow(int row, const QString &group)
+    {
+        beginInsertRows(QModelIndex(), row, row);
+        m_groups.insert(row, group);
+        endInsertRows();
+    }
+
+    QString group(int row) const
+    {
+        return m_groups.at(row);
+    }
+
+    void setGroup(int row, const QString &group)
+    {
+        m_groups[row] = group;
+        Q_EMIT dataChanged(index(row, 0), index(row, 0), {DataEntity::Group});
+    }
+
+private:
+    QVector<QString> m_groups;
+};
+
+/**
+ * @class AppDataBenchmark
+ *
+ * 使用模拟的应用数据测量加载、代理model排序、搜索、信号风暴和收藏操作的耗时
+ * 模拟应用数量由环境变量 LINGMO_MENU_TEST_APPS 指定，结果写入JSON文件
+ */
+class AppDataBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void copyEntity();
+    void sortByInstallTime();
+    void loadCatalog();
+    void sharedStrings();
+    void buildProxyChain();
+    void switchSortMode();
+    void readListModel();
+    void searchIndex_data();
+    void searchIndex();
+    void refineSearch();
+    void searchRanking();
+    void searchService();
+    void updateOneApp();
+    void updateStorm();
+    void addBurst();
+    void addAndDeleteStorm();
+    void groupInsertStorm();
+    void regroupOnDataChanged();
+    void favorites();
+    void cleanupTestCase();
+
+private:
+    void verifyListModel() const;
+
+private:
+    int m_appCount {0};
+    AppCategoryPlugin *m_categoryPlugin {nullptr};
+    AppListModel *m_listModel {nullptr};
+    AppGroupModel *m_groupModel {nullptr};
+    AppSearchIndex *m_searchIndex {nullptr};
+};
+
+void AppDataBenchmark::initTestCase()
+{
+    QVERIFY2(!qEnvironmentVariableIsEmpty(BENCHMARK_SANDBOX_ENV), "benchmark must run in a sandbox home");
+    m_appCount = FakeAppDatabase::appCount();
+
+    // 删除上次运行留下的快照，保证第一次加载为冷启动
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/lingmo-menu/").removeRecursively();
+}
+
+void AppDataBenchmark::copyEntity()
+{
+    // 数据在model之间传递时的拷贝和移动，只改变引用计数，不复制数据
+    const DataEntityVector apps = FakeAppDatabase::apps(m_appCount);
+    DataEntityVector copies(apps.size());
+
+    BenchmarkReport::instance()->measure("entity/copyConstruct", BENCHMARK_ITERATIONS, [&] {
+        DataEntityVector vector;
+        vector.reserve(apps.size());
+        for (const auto &app : apps) {
+            vector.append(app);
+        }
+    });
+
+    BenchmarkReport::instance()->measure("entity/copyAssign", BENCHMARK_ITERATIONS, [&] {
+        for (int i = 0; i < apps.size(); ++i) {
+            copies[i] = apps.at(i);
+        }
+    });
+
+    BenchmarkReport::instance()->measure("entity/moveAssign", BENCHMARK_ITERATIONS, [&] {
+        for (int i = 0; i < apps.size(); ++i) {
+            DataEntity app(apps.at(i));
+            copies[i] = std::move(app);
+        }
+    });
+
+    QCOMPARE(copies.last().id(), apps.last().id());
+
+    // 移动赋值后原对象仍可读写，且不影响目标对象
+    DataEntity source(apps.first());
+    DataEntity target;
+    target = std::move(source);
+    source.setName(QStringLiteral("moved"));
+    QCOMPARE(source.name(), QStringLiteral("moved"));
+    QCOMPARE(target.id(), apps.first().id());
+    QCOMPARE(target.name(), apps.first().name());
+}
+
+void AppDataBenchmark::sortByInstallTime()
+{
+    // 最近安装列表的排序: 比较预先解析的时间戳，与每次比较时解析时间字符串对比
+    const DataEntityVector apps = FakeAppDatabase::apps(BENCHMARK_SORT_SIZE);
+    DataEntityVector sorted;
+
+    BenchmarkReport::instance()->measure(QString("entity/sort%1ByTimestamp").arg(BENCHMARK_SORT_SIZE), BENCHMARK_ITERATIONS, [&] {
+        sorted = apps;
+        std::sort(sorted.begin(), sorted.end(), [] (const DataEntity &a, const DataEntity &b) {
+            return a.installTime() > b.installTime();
+        });
+    });
+
+    DataEntityVector parsed;
+    BenchmarkReport::instance()->measure(QString("entity/sort%1ByParsedString").arg(BENCHMARK_SORT_SIZE), BENCHMARK_ITERATIONS, [&] {
+        parsed = apps;
+        std::sort(parsed.begin(), parsed.end(), [] (const DataEntity &a, const DataEntity &b) {
+            return QDateTime::fromString(a.insertTime(), "yyyy-MM-dd hh:mm:ss")
+                   > QDateTime::fromString(b.insertTime(), "yyyy-MM-dd hh:mm:ss");
+        });
+    });
+
+    QCOMPARE(sorted.first().installTime(), parsed.first().installTime());
+}
+
+void AppDataBenchmark::loadCatalog()
+{
+    // BasicAppModel为单例，只能测量一次冷启动加载
+    QElapsedTimer timer;
+    timer.start();
+    BasicAppModel *model = BasicAppModel::instance();
+    while (model->rowCount(QModelIndex()) < m_appCount && timer.elapsed() < BENCHMARK_LOAD_TIMEOUT) {
+        QCoreApplication::processEvents();
+    }
+
+    BenchmarkReport::instance()->record("load", timer.nsecsElapsed(), "ns");
+    QCOMPARE(model->rowCount(QModelIndex()), m_appCount);
+}
+
+void AppDataBenchmark::sharedStrings()
+{
+    // 统计分类和分组字符串的数据量，相同的值共享同一份数据，按数据地址去重即为实际占用
+    BasicAppModel *model = BasicAppModel::instance();
+    QSet<const QChar*> payloads;
+    qreal totalBytes = 0;
+    qreal sharedBytes = 0;
+
+    for (int row = 0; row < model->rowCount(QModelIndex()); ++row) {
+        const DataEntity app = model->appOfIndex(row);
+        for (const QString &value : {app.category(), app.group()}) {
+            const qreal bytes = value.size() * sizeof(QChar);
+            totalBytes += bytes;
+            if (!payloads.contains(value.constData())) {
+                payloads.insert(value.constData());
+                sharedBytes += bytes;
+            }
+        }
+    }
+
+    BenchmarkReport::instance()->record("entity/stringBytes", totalBytes, "bytes");
+    BenchmarkReport::instance()->record("entity/sharedStringBytes", sharedBytes, "bytes");
+    QVERIFY(sharedBytes <= totalBytes);
+}
+
+void AppDataBenchmark::buildProxyChain()
+{
+    // 与全屏界面相同的model链: BasicAppModel -> 分类/最近安装 -> 组合 -> 平铺 -> 分组
+    QElapsedTimer timer;
+    timer.start();
+    m_categoryPlugin = new AppCategoryPlugin(this);
+    m_listModel = new AppListModel(this);
+    m_listModel->installPlugin(m_categoryPlugin);
+    m_groupModel = new AppGroupModel(this);
+    m_groupModel->setSourceModel(m_listModel);
+    BenchmarkReport::instance()->record("proxyChain/build", timer.nsecsElapsed(), "ns");
+
+    timer.restart();
+    m_searchIndex = new AppSearchIndex(this);
+    BenchmarkReport::instance()->record("searchIndex/build", timer.nsecsElapsed(), "ns");
+
+    QVERIFY(m_listModel->rowCount() >= m_appCount);
+}
+
+void AppDataBenchmark::switchSortMode()
+{
+    // 在按分类和按字母排序之间切换，每次切换整个model链重新排序
+    const QList<QAction*> actions = m_categoryPlugin->actions();
+    QVERIFY(actions.size() >= 2);
+
+    int i = 0;
+    BenchmarkReport::instance()->measure("proxyChain/switchSortMode", BENCHMARK_ITERATIONS, [&] {
+        actions.at(++i % 2)->trigger();
+    });
+    QVERIFY(m_listModel->rowCount() >= m_appCount);
+
+    // 切换后平铺列表和分组model的顺序和分组必须与插件model一致
+    for (int mode : {1, 0}) {
+        actions.at(mode)->trigger();
+        verifyListModel();
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+    }
+}
+
+/**
+ * 逐行对比平铺列表与插件model的应用和分组，并检查分组model的分组顺序、每组的应用数量和标签位置
+ */
+void AppDataBenchmark::verifyListModel() const
+{
+    const QAbstractItemModel *sourceModel = m_categoryPlugin->dataModel();
+    QCOMPARE(m_listModel->rowCount(), sourceModel->rowCount(QModelIndex()));
+
+    QStringList groups;
+    QVector<int> groupSizes;
+    for (int row = 0; row < sourceModel->rowCount(QModelIndex()); ++row) {
+        const QModelIndex sourceIndex = sourceModel->index(row, 0, QModelIndex());
+        const QModelIndex index = m_listModel->index(row, 0);
+        const QString group = sourceIndex.data(DataEntity::Group).toString();
+        QCOMPARE(index.data(DataEntity::Id).toString(), sourceIndex.data(DataEntity::Id).toString());
+        QCOMPARE(index.data(DataEntity::Group).toString(), group);
+
+        if (groups.isEmpty() || groups.last() != group) {
+            QCOMPARE(m_listModel->findLabelIndex(group), row);
+            groups.append(group);
+            groupSizes.append(0);
+        }
+        ++groupSizes.last();
+    }
+
+    QCOMPARE(m_groupModel->rowCount(QModelIndex()), groups.size());
+    for (int i = 0; i < groups.size(); ++i) {
+        const QModelIndex groupIndex = m_groupModel->index(i, 0, QModelIndex());
+        QCOMPARE(groupIndex.data(DataEntity::Group).toString(), groups.at(i));
+        QCOMPARE(m_groupModel->rowCount(groupIndex), groupSizes.at(i));
+    }
+}
+
+void AppDataBenchmark::readListModel()
+{
+    // 模拟全屏界面滚动，读取每一行在委托中用到的数据
+    int length = 0;
+    BenchmarkReport::instance()->measure("proxyChain/readAllRows", BENCHMARK_ITERATIONS, [&] {
+        for (int row = 0; row < m_listModel->rowCount(); ++row) {
+            QModelIndex index = m_listModel->index(row, 0);
+            length += index.data(DataEntity::Name).toString().size();
+            length += index.data(DataEntity::Icon).toString().size();
+            length += index.data(DataEntity::Group).toString().size();
+        }
+    });
+    QVERIFY(length > 0);
+}
+
+void AppDataBenchmark::searchIndex_data()
+{
+    QTest::addColumn<QString>("keyword");
+
+    QTest::newRow("single-letter") << "e";
+    QTest::newRow("common-word") << "editor";
+    QTest::newRow("exact-name") << "image text 1";
+    QTest::newRow("pinyin") << "bjq";
+    QTest::newRow("fuzzy") << "tximg";
+    QTest::newRow("no-match") << "qqqq";
+}
+
+void AppDataBenchmark::searchIndex()
+{
+    QFETCH(QString, keyword);
+
+    AppSearchResults results;
+    BenchmarkReport::instance()->measure(QString("search/%1").arg(QTest::currentDataTag()), BENCHMARK_ITERATIONS * 5, [&] {
+        results = m_searchIndex->search(keyword);
+    });
+    BenchmarkReport::instance()->record(QString("search/%1Results").arg(QTest::currentDataTag()), results.size(), "results");
+}
+
+void AppDataBenchmark::refineSearch()
+{
+    const AppSearchResults results = m_searchIndex->search("edit");
+    QVERIFY(!results.isEmpty());
+
+    AppSearchResults refined;
+    BenchmarkReport::instance()->measure("search/refine", BENCHMARK_ITERATIONS * 5, [&] {
+        refined = m_searchIndex->refine(results, "editor");
+    });
+    QCOMPARE(refined.size(), m_searchIndex->search("editor").size());
+}
+
+void AppDataBenchmark::searchRanking()
+{
+    // 启动次数很多的首字母前缀匹配，不会排在从未启动过、匹配位置最靠后的名称包含匹配之前
+    DataEntity letterPrefix;
+    letterPrefix.setId("/usr/share/applications/letter-prefix.desktop");
+    letterPrefix.setName("Zzz");
+    letterPrefix.setFirstLetter("tezz");
+    letterPrefix.setLaunched(1);
+    letterPrefix.setLaunchTimes(std::numeric_limits<int>::max());
+
+    DataEntity nameContains;
+    nameContains.setId("/usr/share/applications/name-contains.desktop");
+    nameContains.setName(QString(200, QLatin1Char('z')) + "te");
+    nameContains.setFirstLetter("zzz");
+
+    const QString keyword = QStringLiteral("te");
+    const int letterScore = AppSearchIndex::score(letterPrefix, keyword) + AppSearchIndex::frecency(letterPrefix);
+    const int nameScore = AppSearchIndex::score(nameContains, keyword) + AppSearchIndex::frecency(nameContains);
+    QVERIFY(AppSearchIndex::frecency(letterPrefix) > 0);
+    QCOMPARE(AppSearchIndex::frecency(nameContains), 0);
+    QVERIFY2(nameScore > letterScore, qPrintable(QString("%1 <= %2").arg(nameScore).arg(letterScore)));
+}
+
+void AppDataBenchmark::searchService()
+{
+    // 本地索引没有结果时使用搜索服务，测量从发起搜索到第一个结果插入搜索model的时间
+    // 包括搜索完成后搜索线程被唤醒、取出结果和搜索model合并插入的一帧
+    const QString keyword = QStringLiteral("qqqq");
+    QVERIFY(m_searchIndex->search(keyword).isEmpty());
+
+    AppSearchPlugin plugin;
+    QAbstractItemModel *model = plugin.dataModel();
+
+    QVector<qreal> samples;
+    QElapsedTimer timer;
+    for (int i = 0; i < BENCHMARK_ITERATIONS * 5; ++i) {
+        plugin.search(QString());
+        QCOMPARE(model->rowCount(QModelIndex()), 0);
+
+        timer.start();
+        plugin.search(keyword);
+        while (model->rowCount(QModelIndex()) == 0 && timer.elapsed() < BENCHMARK_LOAD_TIMEOUT) {
+            QCoreApplication::processEvents();
+        }
+        samples.append(timer.nsecsElapsed());
+        QVERIFY(model->rowCount(QModelIndex()) > 0);
+    }
+
+    BenchmarkReport::instance()->record("search/serviceFirstResult", samples, "ns");
+}
+
+void AppDataBenchmark::updateOneApp()
+{
+    BasicAppModel *model = BasicAppModel::instance();
+    const int row = m_appCount / 2;
+
+    // 一次应用启动: 数据库返回一个应用的启动次数变化
+    BenchmarkReport::instance()->measure("storm/launchOneApp", BENCHMARK_ITERATIONS, [&] {
+        DataEntity app = model->appOfIndex(row);
+        app.setLaunchTimes(app.launchTimes() + 1);
+        FakeAppDatabase::replayUpdateStorm({app}, {DataEntity::LaunchTimes}, 1);
+        FakeAppDatabase::waitForReplay();
+    });
+}
+
+void AppDataBenchmark::updateStorm()
+{
+    BasicAppModel *model = BasicAppModel::instance();
+
+    // 数据库重建后通知全部应用变化，只发送应用id，由数据库接口重新查询，按数据库的批次大小分批发送
+    const int queries = FakeAppDatabase::queryCount();
+    BenchmarkReport::instance()->measure("storm/updateAll", 5, [&] {
+        DataEntityVector apps;
+        apps.reserve(model->rowCount(QModelIndex()));
+        for (int row = 0; row < model->rowCount(QModelIndex()); ++row) {
+            DataEntity app = model->appOfIndex(row);
+            app.setLaunchTimes(app.launchTimes() + 1);
+            apps.append(app);
+        }
+
+        FakeAppDatabase::replayUpdateStorm(apps, {}, 256);
+        FakeAppDatabase::waitForReplay();
+    });
+    BenchmarkReport::instance()->record("storm/updateAllQueries", (FakeAppDatabase::queryCount() - queries) / 5.0, "queries");
+}
+
+void AppDataBenchmark::addBurst()
+{
+    // 一次安装大量应用，数据库接口在一个信号中返回全部应用
+    BasicAppModel *model = BasicAppModel::instance();
+    const int count = model->rowCount(QModelIndex());
+    const DataEntityVector apps = FakeAppDatabase::apps(count, BENCHMARK_BURST_SIZE);
+    QStringList ids;
+    for (const auto &app : apps) {
+        ids.append(app.id());
+    }
+
+    QVector<qreal> samples;
+    QElapsedTimer timer;
+    const int queries = FakeAppDatabase::queryCount();
+    for (int i = 0; i < 5; ++i) {
+        timer.start();
+        FakeAppDatabase::replayAddStorm(apps, apps.size());
+        FakeAppDatabase::waitForReplay();
+        samples.append(timer.nsecsElapsed());
+        QCOMPARE(model->rowCount(QModelIndex()), count + BENCHMARK_BURST_SIZE);
+
+        FakeAppDatabase::replayDeleteStorm(ids, ids.size());
+        FakeAppDatabase::waitForReplay();
+        QCOMPARE(model->rowCount(QModelIndex()), count);
+    }
+
+    BenchmarkReport::instance()->record(QString("storm/add%1Apps").arg(BENCHMARK_BURST_SIZE), samples, "ns");
+    BenchmarkReport::instance()->record(QString("storm/add%1AppsQueries").arg(BENCHMARK_BURST_SIZE),
+                                        (FakeAppDatabase::queryCount() - queries) / 5.0, "queries");
+}
+
+void AppDataBenchmark::addAndDeleteStorm()
+{
+    BasicAppModel *model = BasicAppModel::instance();
+    const int count = model->rowCount(QModelIndex());
+    // 使用超出模拟数据范围的序号，避免与已有应用重复
+    const DataEntityVector apps = FakeAppDatabase::apps(count, BENCHMARK_STORM_SIZE);
+    QStringList ids;
+    for (const auto &app : apps) {
+        ids.append(app.id());
+    }
+
+    QVector<qreal> addSamples, deleteSamples;
+    QElapsedTimer timer;
+    for (int i = 0; i < 3; ++i) {
+        // 逐个安装，每个应用一次信号
+        timer.start();
+        FakeAppDatabase::replayAddStorm(apps, 1);
+        FakeAppDatabase::waitForReplay();
+        addSamples.append(timer.nsecsElapsed());
+        QCOMPARE(model->rowCount(QModelIndex()), count + BENCHMARK_STORM_SIZE);
+
+        // 一次卸载全部
+        timer.start();
+        FakeAppDatabase::replayDeleteStorm(ids, ids.size());
+        FakeAppDatabase::waitForReplay();
+        deleteSamples.append(timer.nsecsElapsed());
+        QCOMPARE(model->rowCount(QModelIndex()), count);
+    }
+
+    BenchmarkReport::instance()->record(QString("storm/add%1SingleApps").arg(BENCHMARK_STORM_SIZE), addSamples, "ns");
+    BenchmarkReport::instance()->record(QString("storm/delete%1Apps").arg(BENCHMARK_STORM_SIZE), deleteSamples, "ns");
+}
+
+void AppDataBenchmark::groupInsertStorm()
+{
+    // 与应用数量无关: 在按分组排列的source中逐行插入，只测量AppGroupModel移动source row的耗时
+    const int groupCount = 26;
+    GroupSourceModel source;
+    AppGroupModel groupModel;
+    groupModel.setSourceModel(&source);
+    for (int i = 0; i < groupCount; ++i) {
+        source.appendRows(QString(QChar('A' + i)), BENCHMARK_SORT_SIZE / groupCount + (i < BENCHMARK_SORT_SIZE % groupCount));
+    }
+    QCOMPARE(groupModel.rowCount(QModelIndex()), groupCount);
+
+    // 插入位置分布在整个列表中，新的行与所在位置的行属于同一组，分组保持连续
+    QVector<qreal> samples;
+    samples.reserve(BENCHMARK_STORM_SIZE);
+    QElapsedTimer timer;
+    for (int i = 0; i < BENCHMARK_STORM_SIZE; ++i) {
+        const int row = int((i * 7919LL) % source.rowCount(QModelIndex()));
+        const QString group = source.group(row);
+        timer.start();
+        source.insertGroupRow(row, group);
+        samples.append(timer.nsecsElapsed());
+    }
+
+    BenchmarkReport::instance()->record(QString("groupModel/insert%1SingleRowsInto%2")
+                                        .arg(BENCHMARK_STORM_SIZE).arg(BENCHMARK_SORT_SIZE), samples, "ns");
+
+    // 每个分组中的行映射回source后仍属于该分组
+    int rows = 0;
+    for (int i = 0; i < groupModel.rowCount(QModelIndex()); ++i) {
+        const QModelIndex groupIndex = groupModel.index(i, 0, QModelIndex());
+        const QString group = groupIndex.data(DataEntity::Group).toString();
+        const int childCount = groupModel.rowCount(groupIndex);
+        for (int j = 0; j < childCount; ++j) {
+            const QModelIndex sourceIndex = groupModel.mapToSource(groupModel.index(j, 0, groupIndex));
+            QCOMPARE(source.group(sourceIndex.row()), group);
+        }
+        rows += childCount;
+    }
+    QCOMPARE(rows, BENCHMARK_SORT_SIZE + BENCHMARK_STORM_SIZE);
+}
+
+void AppDataBenchmark::regroupOnDataChanged()
+{
+    // 应用的分组变化时移动到新的分组，原分组为空时删除
+    GroupSourceModel source;
+    AppGroupModel groupModel;
+    groupModel.setSourceModel(&source);
+    source.appendRows("A", 2);
+    source.appendRows("B", 1);
+
+    source.setGroup(2, "C");
+    QCOMPARE(groupModel.findLabelIndex("B"), -1);
+    const int groupIndex = groupModel.findLabelIndex("C");
+    QVERIFY(groupIndex >= 0);
+    const QModelIndex group = groupModel.index(groupIndex, 0, QModelIndex());
+    QCOMPARE(group.data(DataEntity::Group).toString(), QString("C"));
+    QCOMPARE(groupModel.rowCount(group), 1);
+    QCOMPARE(groupModel.mapToSource(groupModel.index(0, 0, group)).row(), 2);
+
+    source.setGroup(0, "C");
+    QCOMPARE(groupModel.rowCount(groupModel.index(groupModel.findLabelIndex("A"), 0, QModelIndex())), 1);
+    QCOMPARE(groupModel.rowCount(groupModel.index(groupModel.findLabelIndex("C"), 0, QModelIndex())), 2);
+}
+
+void AppDataBenchmark::favorites()
+{
+    BasicAppModel *model = BasicAppModel::instance();
+    FavoritesModel &favoritesModel = FavoritesModel::instance();
+    favoritesModel.setSourceModel(&AppFavoritesModel::instance());
+    favoritesModel.sort(0);
+
+    const int count = qMin(BENCHMARK_FAVORITE_COUNT, m_appCount);
+    QStringList ids;
+    for (int row = 0; row < count; ++row) {
+        ids.append(model->appOfIndex(row).id());
+    }
+
+    // 逐个收藏，数据库的收藏状态通过信号返回
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto &id : ids) {
+        favoritesModel.addAppToFavorites(id);
+        FakeAppDatabase::waitForReplay();
+    }
+    BenchmarkReport::instance()->record(QString("favorites/add%1").arg(count), timer.nsecsElapsed(), "ns");
+    QVERIFY(favoritesModel.rowCount() >= count);
+
+    // 拖拽调整顺序
+    BenchmarkReport::instance()->measure("favorites/reorder", BENCHMARK_ITERATIONS, [&] {
+        FavoritesConfig::instance().changeOrder(0, count - 1);
+    });
+
+    timer.start();
+    favoritesModel.clearFavorites();
+    FakeAppDatabase::waitForReplay();
+    BenchmarkReport::instance()->record("favorites/clear", timer.nsecsElapsed(), "ns");
+}
+
+void AppDataBenchmark::cleanupTestCase()
+{
+    QString fileName = qEnvironmentVariable(BENCHMARK_OUTPUT_ENV);
+    if (fileName.isEmpty()) {
+        fileName = QString("app-data-benchmark-%1.json").arg(m_appCount);
+    }
+
+    QVERIFY(BenchmarkReport::instance()->save(fileName, m_appCount));
+    qInfo() << "benchmark results:" << QFileInfo(fileName).absoluteFilePath();
+}
+
+/**
+ * 配置文件和快照的路径在静态初始化时由HOME得到，进程启动后再修改环境变量已经来不及
+ * 因此先创建临时的用户目录，在子进程中运行测试，结束后删除该目录，不会读写真实的配置和快照
+ */
+static int runInSandbox(char *argv[])
+{
+    QByteArray sandbox = QDir::tempPath().toLocal8Bit() + "/lingmo-menu-benchmark-XXXXXX";
+    if (!mkdtemp(sandbox.data())) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    QDir(QString::fromLocal8Bit(sandbox)).mkpath(".config");
+    qputenv(BENCHMARK_SANDBOX_ENV, sandbox);
+    qputenv("HOME", sandbox);
+    qputenv("XDG_CONFIG_HOME", sandbox + "/.config");
+    qputenv("XDG_CACHE_HOME", sandbox + "/.cache");
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    int result = EXIT_FAILURE;
+    pid_t pid = fork();
+    if (pid == 0) {
+        execv("/proc/self/exe", argv);
+        perror("execv");
+        _exit(EXIT_FAILURE);
+    } else if (pid > 0) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) == pid && WIFEXITED(status)) {
+            result = WEXITSTATUS(status);
+        }
+    } else {
+        perror("fork");
+    }
+
+    QDir(QString::fromLocal8Bit(sandbox)).removeRecursively();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty(BENCHMARK_SANDBOX_ENV)) {
+        return runInSandbox(argv);
+    }
+
+    QApplication app(argc, argv);
+    AppDataBenchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "app-data-benchmark.moc"
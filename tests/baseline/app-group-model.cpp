@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Authors: hxf <hewenfei@lingmoos.cn>
+ *
+ */
+
+#include "app-group-model.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace LingmoMenu {
+
+AppGroupModel::AppGroupModel(QObject *parent) : QAbstractProxyModel(parent)
+{
+
+}
+
+QModelIndex AppGroupModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column != 0 || row < 0) {
+        return {};
+    }
+
+    // 通过parent找到所属的组，将组的信息放入index附带数据中，作为判断依据
+    if (parent.isValid()) {
+        const auto subItems = m_groups.at(parent.row());
+        if (row >= subItems->size()) {
+            return {};
+        }
+
+        return createIndex(row, column, subItems);
+    }
+
+    return createIndex(row, column, nullptr);
+}
+
+QModelIndex AppGroupModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid()) {
+        return {};
+    }
+
+    auto subItems = static_cast<QVector<int>*>(child.internalPointer());
+    if (subItems) {
+        return createIndex(m_groups.indexOf(subItems), 0);
+    }
+
+    return {};
+}
+
+bool AppGroupModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!sourceModel()) {
+        return false;
+    }
+
+    // root
+    if (!parent.isValid()) {
+        return !m_groups.isEmpty();
+    }
+
+    // child, 两层
+    if (parent.parent().isValid()) {
+        return false;
+    }
+
+    return true;
+}
+
+int AppGroupModel::rowCount(const QModelIndex &parent) const
+{
+    if (!sourceModel()) {
+        return 0;
+    }
+
+    // root
+    if (!parent.isValid()) {
+        return m_groups.size();
+    }
+
+    if (parent.parent().isValid()) {
+        return 0;
+    }
+
+    int i = parent.row();
+    if (i < 0 || i >= m_groups.size()) {
+        return 0;
+    }
+
+    return m_groups.at(i)->size();
+}
+
+int AppGroupModel::columnCount(const QModelIndex &parent) const
+{
+    return 1;
+}
+
+QHash<int, QByteArray> AppGroupModel::roleNames() const
+{
+    return QAbstractItemModel::roleNames();
+}
+
+void AppGroupModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (AppGroupModel::sourceModel() == sourceModel) {
+        return;
+    }
+
+    beginResetModel();
+    if (AppGroupModel::sourceModel()) {
+        AppGroupModel::sourceModel()->disconnect(this);
+    }
+
+    QAbstractProxyModel::setSourceModel(sourceModel);
+
+    if (sourceModel) {
+        rebuildAppGroups();
+
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &AppGroupModel::onDataChanged);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &AppGroupModel::onLayoutChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &AppGroupModel::onRowsInserted);
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &AppGroupModel::onRowsAboutToBeRemoved);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, [=] (const QModelIndex &parent, int first, int last) {
+            if (m_needRebuild) {
+                beginResetModel();
+                rebuildAppGroups();
+                endResetModel();
+                m_needRebuild = false;
+
+            } else if (!parent.isValid()) {
+                m_sourceMap.remove(first, last - first + 1);
+                reLocationIndex(first, -(last - first + 1));
+            }
+        });
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, [=] {
+            beginResetModel();
+            rebuildAppGroups();
+            endResetModel();
+        });
+    }
+
+    endResetModel();
+}
+
+QModelIndex AppGroupModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!sourceModel() || !proxyIndex.isValid()) {
+        return {};
+    }
+
+    auto subItems = static_cast<QVector<int>*>(proxyIndex.internalPointer());
+    if (subItems) {
+        int idx = subItems->at(proxyIndex.row());
+        return sourceModel()->index(idx, 0);
+    }
+
+    return {};
+}
+
+QModelIndex AppGroupModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceModel() || !sourceIndex.isValid()) {
+        return {};
+    }
+
+    const QPair<int, int> position = m_sourceMap.value(sourceIndex.row(), {-1, -1});
+    if (position.first < 0) {
+        return {};
+    }
+
+    return index(position.second, 0, index(position.first, 0, QModelIndex()));
+}
+
+QVariant AppGroupModel::data(const QModelIndex &proxyIndex, int role) const
+{
+    if (!checkIndex(proxyIndex, CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    if (proxyIndex.parent().isValid()) {
+        return QAbstractProxyModel::data(proxyIndex, role);
+    }
+
+    if (role == DataEntity::Name || role == DataEntity::Group) {
+        return m_groupNames.at(proxyIndex.row());
+    }
+
+    return {};
+}
+
+void AppGroupModel::rebuildAppGroups()
+{
+    qDeleteAll(m_groups);
+    m_groups.clear();
+    m_groupNames.clear();
+    m_groupIndexes.clear();
+
+    int rowCount = sourceModel()->rowCount();
+    m_sourceMap.resize(rowCount);
+
+    for (int i = 0; i < rowCount; ++i) {
+        // 使用group属性进行分组
+        QString group = sourceModel()->index(i, 0).data(DataEntity::Group).toString();
+        int groupIndex = m_groupIndexes.value(group, -1);
+        if (groupIndex < 0) {
+            groupIndex = m_groups.size();
+            m_groups.append(new QVector<int>());
+            m_groupNames.append(group);
+            m_groupIndexes.insert(group, groupIndex);
+        }
+
+        QVector<int> *subItems = m_groups[groupIndex];
+        m_sourceMap[i] = {groupIndex, subItems->size()};
+        subItems->append(i);
+    }
+}
+
+void AppGroupModel::updateGroupIndexes(int from)
+{
+    for (int i = from; i < m_groups.size(); ++i) {
+        m_groupIndexes[m_groupNames.at(i)] = i;
+        for (int sourceRow : *m_groups.at(i)) {
+            m_sourceMap[sourceRow].first = i;
+        }
+    }
+}
+
+void AppGroupModel::updateItemPositions(int groupIndex, int from)
+{
+    const QVector<int> *subItems = m_groups.at(groupIndex);
+    for (int i = from; i < subItems->size(); ++i) {
+        m_sourceMap[subItems->at(i)].second = i;
+    }
+}
+
+void AppGroupModel::insertApp(const QModelIndex &sourceIndex)
+{
+    int sourceRow = sourceIndex.row();
+    QString group = sourceIndex.data(DataEntity::Group).toString();
+    int groupIndex = m_groupIndexes.value(group, -1);
+
+    if (groupIndex < 0) {
+        groupIndex = 0;
+        if (sourceRow > 0) {
+            // 新的组放在前一个item所在组的后面
+            int previous = m_sourceMap.value(sourceRow - 1, {-1, -1}).first;
+            groupIndex = (previous < 0) ? m_groups.size() : previous + 1;
+        }
+
+        beginInsertRows(QModelIndex(), groupIndex, groupIndex);
+        m_groups.insert(groupIndex, new QVector<int>(1, sourceRow));
+        m_groupNames.insert(groupIndex, group);
+        m_sourceMap[sourceRow] = {groupIndex, 0};
+        updateGroupIndexes(groupIndex);
+        endInsertRows();
+        return;
+    }
+
+    // 组内按source row升序排列
+    QVector<int> *subItems = m_groups[groupIndex];
+    int index = int(std::upper_bound(subItems->constBegin(), subItems->constEnd(), sourceRow) - subItems->constBegin());
+
+    beginInsertRows(AppGroupModel::index(groupIndex, 0, QModelIndex()), index, index);
+    subItems->insert(index, sourceRow);
+    updateItemPositions(groupIndex, index);
+    endInsertRows();
+}
+
+// slots
+void AppGroupModel::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
+        QModelIndex proxyIndex = mapFromSource(sourceModel()->index(i, 0));
+        Q_EMIT dataChanged(proxyIndex, proxyIndex, roles);
+    }
+}
+
+void AppGroupModel::onLayoutChanged(const QList<QPersistentModelIndex> &parents, QAbstractItemModel::LayoutChangeHint hint)
+{
+    Q_UNUSED(parents)
+    Q_UNUSED(hint)
+    beginResetModel();
+    rebuildAppGroups();
+    endResetModel();
+}
+
+void AppGroupModel::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    if (first < (sourceModel()->rowCount() - 1)) {
+        reLocationIndex(first, (last - first + 1));
+    }
+
+    m_sourceMap.insert(first, last - first + 1, {-1, -1});
+    for (int i = first; i <= last; ++i) {
+        insertApp(sourceModel()->index(i, 0, parent));
+    }
+}
+
+void AppGroupModel::reLocationIndex(int base, int offset)
+{
+    for (QVector<int> *group : m_groups) {
+        QMutableVectorIterator<int> it(*group);
+        while (it.hasNext()) {
+            const int &value = it.next();
+            if (value >= base) {
+                it.setValue(value + offset);
+            }
+        }
+    }
+}
+
+void AppGroupModel::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    for (int i = first; i <= last; ++i) {
+        const QPair<int, int> position = m_sourceMap.value(i, {-1, -1});
+        if (position.first < 0) {
+            continue;
+        }
+
+        int groupIndex = position.first, itemIndex = position.second;
+        auto subItems = m_groups[groupIndex];
+        if (itemIndex >= subItems->size() || subItems->at(itemIndex) != i) {
+            // 如果出现错误，那么重新构建映射关系
+            m_needRebuild = true;
+            break;
+        }
+
+        m_sourceMap[i] = {-1, -1};
+        if (subItems->size() > 1) {
+            // 删除组里的元素
+            beginRemoveRows(index(groupIndex, 0, QModelIndex()), itemIndex, itemIndex);
+            subItems->removeAt(itemIndex);
+            updateItemPositions(groupIndex, itemIndex);
+            endRemoveRows();
+        } else {
+            // 删除组
+            beginRemoveRows(QModelIndex(), groupIndex, groupIndex);
+            delete m_groups.takeAt(groupIndex);
+            m_groupIndexes.remove(m_groupNames.takeAt(groupIndex));
+            updateGroupIndexes(groupIndex);
+            endRemoveRows();
+        }
+    }
+}
+
+int AppGroupModel::findLabelIndex(const QString &label) const
+{
+    return m_groupIndexes.value(label, -1);
+}
+
+} // LingmoMenu
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "benchmark-report.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+namespace LingmoMenu {
+
+BenchmarkReport *BenchmarkReport::instance()
+{
+    static BenchmarkReport report;
+    return &report;
+}
+
+void BenchmarkReport::measure(const QString &name, int iterations, const std::function<void()> &func)
+{
+    QVector<qreal> samples;
+    samples.reserve(iterations);
+
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        func();
+        samples.append(timer.nsecsElapsed());
+    }
+
+    record(name, samples, QStringLiteral("ns"));
+}
+
+void BenchmarkReport::record(const QString &name, const QVector<qreal> &samples, const QString &unit)
+{
+    if (samples.isEmpty()) {
+        return;
+    }
+
+    QVector<qreal> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    Result result;
+    result.name = name;
+    result.unit = unit;
+    result.samples = sorted.size();
+    result.median = sorted.at(sorted.size() / 2);
+    result.p99 = sorted.at(qMin(sorted.size() - 1, int(sorted.size() * 0.99)));
+    result.min = sorted.first();
+    m_results.append(result);
+
+    qInfo().noquote() << name << "median:" << result.median << unit << "p99:" << result.p99 << unit
+                      << "samples:" << result.samples;
+}
+
+void BenchmarkReport::record(const QString &name, qreal value, const QString &unit)
+{
+    record(name, QVector<qreal>{value}, unit);
+}
+
+bool BenchmarkReport::save(const QString &fileName, int appCount) const
+{
+    QJsonArray results;
+    for (const auto &result : m_results) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), result.name);
+        object.insert(QStringLiteral("unit"), result.unit);
+        object.insert(QStringLiteral("samples"), result.samples);
+        object.insert(QStringLiteral("median"), result.median);
+        object.insert(QStringLiteral("p99"), result.p99);
+        object.insert(QStringLiteral("min"), result.min);
+        results.append(object);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("benchmark"), QStringLiteral("app-data-benchmark"));
+    root.insert(QStringLiteral("apps"), appCount);
+    root.insert(QStringLiteral("qtVersion"), QString::fromLatin1(qVersion()));
+    root.insert(QStringLiteral("time"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    root.insert(QStringLiteral("results"), results);
+
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        qWarning() << "BenchmarkReport: can not write" << fileName;
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+} // LingmoMenu
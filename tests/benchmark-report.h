@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINGMO_MENU_BENCHMARK_REPORT_H
+#define LINGMO_MENU_BENCHMARK_REPORT_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+
+namespace LingmoMenu {
+
+/**
+ * @class BenchmarkReport
+ *
+ * 记录基准测试结果，输出为JSON文件，用于对比不同版本的性能
+ * 每项结果保存全部样本的中位数、p99和最小值
+ */
+class BenchmarkReport
+{
+public:
+    static BenchmarkReport *instance();
+
+    /**
+     * 重复执行func并记录每次的耗时(ns)
+     * @param name 测试项名称
+     * @param iterations 执行次数
+     */
+    void measure(const QString &name, int iterations, const std::function<void()> &func);
+
+    /**
+     * 记录一组已经测量好的样本
+     * @param unit 样本的单位，如ns、bytes
+     */
+    void record(const QString &name, const QVector<qreal> &samples, const QString &unit);
+    void record(const QString &name, qreal value, const QString &unit);
+
+    /**
+     * 写入JSON文件
+     * @param appCount 测试使用的模拟应用数量
+     */
+    bool save(const QString &fileName, int appCount) const;
+
+private:
+    struct Result
+    {
+        QString name;
+        QString unit;
+        int samples {0};
+        qreal median {0};
+        qreal p99 {0};
+        qreal min {0};
+    };
+
+    QVector<Result> m_results;
+};
+
+} // LingmoMenu
+
+#endif //LINGMO_MENU_BENCHMARK_REPORT_H
@@ -0,0 +1,434 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "fake-app-database.h"
+
+#include <application-info.h>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QThread>
+
+// 默认的模拟应用数量
+#define FAKE_APP_DEFAULT_COUNT 5000
+// 模拟一次数据库查询的往返时间(us)，真实的数据库接口每次查询都要访问搜索服务
+#define FAKE_APP_QUERY_LATENCY 100
+
+namespace LingmoMenu {
+
+static const char *const categories[] = {
+    "Development", "Office", "Graphics", "Network", "AudioVideo",
+    "Game", "Education", "System", "Settings", "Utility"
+};
+
+static const char *const words[] = {
+    "Text", "Image", "Music", "Video", "Mail", "Web", "Terminal", "Office",
+    "Photo", "Code", "Chess", "Player", "Editor", "Viewer", "Manager", "Browser"
+};
+
+// 与words一一对应的中文名称及其拼音首字母
+static const char *const chineseWords[] = {
+    "文本", "图像", "音乐", "视频", "邮件", "网页", "终端", "办公",
+    "照片", "代码", "象棋", "播放器", "编辑器", "查看器", "管理器", "浏览器"
+};
+
+static const char *const pinyinLetters[] = {
+    "wb", "tx", "yy", "sp", "yj", "wy", "zd", "bg",
+    "zp", "dm", "xq", "bfq", "bjq", "ckq", "glq", "llq"
+};
+
+// 模拟的应用数据库，由数据库接口的工作线程和测试线程共同访问
+static QMutex databaseMutex;
+static LingmoSearch::ApplicationInfoMap database;
+static bool databaseInitialized = false;
+// 数据库接口在工作线程中创建的ApplicationInfo，数据库的信号都由它在工作线程中发出
+static QAtomicPointer<LingmoSearch::ApplicationInfo> applicationInfo;
+// 工作线程中执行过的数据库操作数量，用于判断是否还有未完成的操作
+static QAtomicInt databaseActivity;
+static QAtomicInt databaseQueries;
+
+static LingmoSearch::ApplicationPropertyMap toInfo(const DataEntity &app)
+{
+    LingmoSearch::ApplicationPropertyMap info;
+    info.insert(LingmoSearch::ApplicationProperty::DesktopFilePath, app.id());
+    info.insert(LingmoSearch::ApplicationProperty::LocalName, app.name());
+    info.insert(LingmoSearch::ApplicationProperty::FirstLetterAll, app.firstLetter());
+    info.insert(LingmoSearch::ApplicationProperty::Icon, app.icon());
+    info.insert(LingmoSearch::ApplicationProperty::Category, app.category());
+    info.insert(LingmoSearch::ApplicationProperty::InsertTime, app.insertTime());
+    info.insert(LingmoSearch::ApplicationProperty::LaunchTimes, app.launchTimes());
+    info.insert(LingmoSearch::ApplicationProperty::Launched, app.launched());
+    info.insert(LingmoSearch::ApplicationProperty::Favorites, app.favorite());
+    info.insert(LingmoSearch::ApplicationProperty::Top, app.top());
+    info.insert(LingmoSearch::ApplicationProperty::Lock, app.isLock() ? 1 : 0);
+    info.insert(LingmoSearch::ApplicationProperty::DontDisplay, 0);
+    info.insert(LingmoSearch::ApplicationProperty::AutoStart, 0);
+    return info;
+}
+
+/**
+ * DataEntity的属性对应的数据库属性
+ * @return 数据库中没有对应的属性时返回Invalid
+ */
+static LingmoSearch::ApplicationProperty::Property toProperty(int role)
+{
+    switch (role) {
+        case DataEntity::Name:
+            return LingmoSearch::ApplicationProperty::LocalName;
+        case DataEntity::FirstLetter:
+            return LingmoSearch::ApplicationProperty::FirstLetterAll;
+        case DataEntity::Icon:
+            return LingmoSearch::ApplicationProperty::Icon;
+        case DataEntity::Category:
+            return LingmoSearch::ApplicationProperty::Category;
+        case DataEntity::InstallationTime:
+            return LingmoSearch::ApplicationProperty::InsertTime;
+        case DataEntity::LaunchTimes:
+            return LingmoSearch::ApplicationProperty::LaunchTimes;
+        case DataEntity::IsLaunched:
+            return LingmoSearch::ApplicationProperty::Launched;
+        case DataEntity::Favorite:
+            return LingmoSearch::ApplicationProperty::Favorites;
+        case DataEntity::Top:
+            return LingmoSearch::ApplicationProperty::Top;
+        case DataEntity::IsLocked:
+            return LingmoSearch::ApplicationProperty::Lock;
+        default:
+            return LingmoSearch::ApplicationProperty::Invalid;
+    }
+}
+
+static void initDatabase()
+{
+    QMutexLocker locker(&databaseMutex);
+    if (databaseInitialized) {
+        return;
+    }
+
+    for (const auto &app : FakeAppDatabase::apps(FakeAppDatabase::appCount())) {
+        database.insert(app.id(), toInfo(app));
+    }
+    databaseInitialized = true;
+}
+
+/**
+ * 在工作线程中发送数据库信号，与真实的数据库接口一样
+ */
+template <typename Func>
+static void postToWorker(Func func)
+{
+    LingmoSearch::ApplicationInfo *info = applicationInfo.load();
+    if (!info) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(info, [func, info] {
+        databaseActivity.ref();
+        func(info);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * 等待工作线程处理完此前投递给它的全部操作
+ */
+static void syncWorker()
+{
+    LingmoSearch::ApplicationInfo *info = applicationInfo.load();
+    if (info && QThread::currentThread() != info->thread()) {
+        QMetaObject::invokeMethod(info, [] {}, Qt::BlockingQueuedConnection);
+    }
+}
+
+int FakeAppDatabase::appCount()
+{
+    bool ok = false;
+    int count = qEnvironmentVariableIntValue("LINGMO_MENU_TEST_APPS", &ok);
+    return (ok && count > 0) ? count : FAKE_APP_DEFAULT_COUNT;
+}
+
+DataEntity FakeAppDatabase::app(int index)
+{
+    const int wordCount = sizeof(words) / sizeof(words[0]);
+    const int categoryCount = sizeof(categories) / sizeof(categories[0]);
+
+    int first = index % wordCount;
+    int second = (index / wordCount) % wordCount;
+
+    QString name;
+    QString letters;
+    if (index % 3 == 0) {
+        // 约三分之一为中文名称，首字母为拼音首字母
+        name = QString("%1%2 %3").arg(QString::fromUtf8(chineseWords[first]), QString::fromUtf8(chineseWords[second])).arg(index);
+        letters = QString("%1%2%3").arg(QString::fromLatin1(pinyinLetters[first]), QString::fromLatin1(pinyinLetters[second])).arg(index);
+    } else {
+        name = QString("%1 %2 %3").arg(QString::fromLatin1(words[first]), QString::fromLatin1(words[second])).arg(index);
+        letters = name.toLower().remove(QLatin1Char(' '));
+    }
+
+    DataEntity app;
+    app.setType(DataType::Normal);
+    app.setId(QString("/usr/share/applications/fake-app-%1.desktop").arg(index));
+    app.setName(name);
+    app.setIcon(QString("image://theme/fake-app-%1").arg(index));
+    app.setCategory(QString::fromLatin1(categories[index % categoryCount]));
+    app.setFirstLetter(letters);
+    // 约十分之一的应用为最近30天内安装
+    qint64 installTime = QDateTime::currentSecsSinceEpoch() - (index % 10 == 0 ? 3600 : 3600 * 24 * 90) - index;
+    app.setInsertTime(QDateTime::fromSecsSinceEpoch(installTime).toString("yyyy-MM-dd hh:mm:ss"));
+    app.setLaunchTimes(index % 7 == 0 ? 0 : index % 50);
+    app.setLaunched(index % 7 == 0 ? 0 : 1);
+    return app;
+}
+
+DataEntityVector FakeAppDatabase::apps(int count)
+{
+    return apps(0, count);
+}
+
+DataEntityVector FakeAppDatabase::apps(int first, int count)
+{
+    DataEntityVector apps;
+    apps.reserve(count);
+    for (int i = first; i < first + count; ++i) {
+        apps.append(app(i));
+    }
+
+    return apps;
+}
+
+void FakeAppDatabase::replayAddStorm(const DataEntityVector &apps, int burstSize)
+{
+    initDatabase();
+    burstSize = qMax(1, burstSize);
+    for (int offset = 0; offset < apps.size(); offset += burstSize) {
+        QStringList burst;
+        {
+            QMutexLocker locker(&databaseMutex);
+            for (int i = offset; i < qMin(offset + burstSize, apps.size()); ++i) {
+                database.insert(apps.at(i).id(), toInfo(apps.at(i)));
+                burst.append(apps.at(i).id());
+            }
+        }
+
+        postToWorker([burst] (LingmoSearch::ApplicationInfo *info) {
+            Q_EMIT info->appDBItems2BAdd(burst);
+        });
+    }
+}
+
+void FakeAppDatabase::replayUpdateStorm(const DataEntityVector &apps, const QVector<int> &roles, int burstSize)
+{
+    initDatabase();
+    burstSize = qMax(1, burstSize);
+    for (int offset = 0; offset < apps.size(); offset += burstSize) {
+        QStringList ids;
+        LingmoSearch::ApplicationInfoMap changes;
+        {
+            QMutexLocker locker(&databaseMutex);
+            for (int i = offset; i < qMin(offset + burstSize, apps.size()); ++i) {
+                const DataEntity &app = apps.at(i);
+                if (roles.isEmpty()) {
+                    database.insert(app.id(), toInfo(app));
+                    ids.append(app.id());
+                    continue;
+                }
+
+                const LingmoSearch::ApplicationPropertyMap info = toInfo(app);
+                LingmoSearch::ApplicationPropertyMap &stored = database[app.id()];
+                for (int role : roles) {
+                    LingmoSearch::ApplicationProperty::Property property = toProperty(role);
+                    if (property != LingmoSearch::ApplicationProperty::Invalid) {
+                        stored.insert(property, info.value(property));
+                        changes[app.id()].insert(property, info.value(property));
+                    }
+                }
+            }
+        }
+
+        postToWorker([ids, changes] (LingmoSearch::ApplicationInfo *info) {
+            if (!ids.isEmpty()) {
+                Q_EMIT info->appDBItems2BUpdateAll(ids);
+            }
+            if (!changes.isEmpty()) {
+                Q_EMIT info->appDBItems2BUpdate(changes);
+            }
+        });
+    }
+}
+
+void FakeAppDatabase::replayDeleteStorm(const QStringList &appIds, int burstSize)
+{
+    initDatabase();
+    burstSize = qMax(1, burstSize);
+    for (int offset = 0; offset < appIds.size(); offset += burstSize) {
+        QStringList burst = appIds.mid(offset, burstSize);
+        {
+            QMutexLocker locker(&databaseMutex);
+            for (const auto &appid : burst) {
+                database.remove(appid);
+            }
+        }
+
+        postToWorker([burst] (LingmoSearch::ApplicationInfo *info) {
+            Q_EMIT info->appDBItems2BDelete(burst);
+        });
+    }
+}
+
+void FakeAppDatabase::waitForReplay()
+{
+    // 工作线程的信号由界面线程处理，处理时可能再次访问数据库，直到一轮中没有新的数据库操作为止
+    int activity = 0;
+    do {
+        activity = databaseActivity.load();
+        syncWorker();
+        QCoreApplication::processEvents();
+        syncWorker();
+    } while (activity != databaseActivity.load());
+
+    // 处理最后一批信号触发的合并更新
+    QCoreApplication::processEvents();
+}
+
+int FakeAppDatabase::queryCount()
+{
+    return databaseQueries.load();
+}
+
+} // LingmoMenu
+
+// ====== ApplicationInfo ====== //
+// 代替 lingmo-search 的实现，由 src/libappdata/app-database-interface.cpp 在工作线程中创建和调用
+namespace LingmoSearch {
+
+ApplicationInfo::ApplicationInfo(QObject *parent) : QObject(parent)
+{
+    LingmoMenu::initDatabase();
+    LingmoMenu::applicationInfo.store(this);
+}
+
+ApplicationInfo::~ApplicationInfo()
+{
+    LingmoMenu::applicationInfo.testAndSetOrdered(this, nullptr);
+}
+
+ApplicationPropertyMap ApplicationInfo::getInfo(const QString &desktopFile, ApplicationProperties properties)
+{
+    LingmoMenu::databaseActivity.ref();
+    LingmoMenu::databaseQueries.ref();
+    QThread::usleep(FAKE_APP_QUERY_LATENCY);
+
+    QMutexLocker locker(&LingmoMenu::databaseMutex);
+    ApplicationPropertyMap info;
+    auto it = LingmoMenu::database.constFind(desktopFile);
+    if (it != LingmoMenu::database.constEnd()) {
+        for (const auto &property : properties) {
+            info.insert(property, it.value().value(property));
+        }
+    }
+
+    return info;
+}
+
+ApplicationInfoMap ApplicationInfo::getInfo(ApplicationProperties properties, ApplicationPropertyMap restrictions)
+{
+    LingmoMenu::databaseActivity.ref();
+    LingmoMenu::databaseQueries.ref();
+    QThread::usleep(FAKE_APP_QUERY_LATENCY);
+
+    QMutexLocker locker(&LingmoMenu::databaseMutex);
+    ApplicationInfoMap infos;
+    for (auto it = LingmoMenu::database.constBegin(); it != LingmoMenu::database.constEnd(); ++it) {
+        bool accepted = true;
+        for (auto restriction = restrictions.constBegin(); restriction != restrictions.constEnd(); ++restriction) {
+            if (it.value().value(restriction.key()) != restriction.value()) {
+                accepted = false;
+                break;
+            }
+        }
+
+        if (!accepted) {
+            continue;
+        }
+
+        ApplicationPropertyMap &info = infos[it.key()];
+        for (const auto &property : properties) {
+            info.insert(property, it.value().value(property));
+        }
+    }
+
+    return infos;
+}
+
+bool ApplicationInfo::setAppToFavorites(const QString &desktopFilePath)
+{
+    int favorite = 0;
+    {
+        QMutexLocker locker(&LingmoMenu::databaseMutex);
+        for (const auto &info : LingmoMenu::database) {
+            favorite = qMax(favorite, info.value(ApplicationProperty::Favorites).toInt());
+        }
+    }
+
+    setAppProperty(desktopFilePath, ApplicationProperty::Favorites, favorite + 1);
+    return true;
+}
+
+bool ApplicationInfo::setFavoritesOfApp(const QString &desktopFilePath, size_t num)
+{
+    setAppProperty(desktopFilePath, ApplicationProperty::Favorites, int(num));
+    return true;
+}
+
+bool ApplicationInfo::setTopOfApp(const QString &desktopFilePath, size_t num)
+{
+    setAppProperty(desktopFilePath, ApplicationProperty::Top, int(num));
+    return true;
+}
+
+bool ApplicationInfo::setAppLaunchedState(const QString &desktopFilePath, bool launched)
+{
+    setAppProperty(desktopFilePath, ApplicationProperty::Launched, launched ? 1 : 0);
+    return true;
+}
+
+/**
+ * 写入数据库，与真实的数据库一样，修改后的数据通过appDBItems2BUpdate信号异步返回
+ */
+void ApplicationInfo::setAppProperty(const QString &desktopFilePath, ApplicationProperty::Property property, const QVariant &value)
+{
+    LingmoMenu::databaseActivity.ref();
+    {
+        QMutexLocker locker(&LingmoMenu::databaseMutex);
+        auto it = LingmoMenu::database.find(desktopFilePath);
+        if (it == LingmoMenu::database.end()) {
+            return;
+        }
+        it.value().insert(property, value);
+    }
+
+    ApplicationInfoMap changes;
+    changes[desktopFilePath].insert(property, value);
+    LingmoMenu::postToWorker([changes] (ApplicationInfo *info) {
+        Q_EMIT info->appDBItems2BUpdate(changes);
+    });
+}
+
+} // LingmoSearch
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINGMO_MENU_FAKE_APP_DATABASE_H
+#define LINGMO_MENU_FAKE_APP_DATABASE_H
+
+#include "app-database-interface.h"
+
+namespace LingmoMenu {
+
+/**
+ * 测试用的应用数据
+ * 代替 lingmo-search 的应用数据库(ApplicationInfo)，在内存中保存指定数量的模拟应用
+ * AppDatabaseInterface 使用真实的实现，查询和过滤都在其工作线程中进行
+ * 与真实的数据库一样，变化通过ApplicationInfo的信号在工作线程中通知
+ */
+class FakeAppDatabase
+{
+public:
+    /**
+     * 模拟应用的数量，由环境变量 LINGMO_MENU_TEST_APPS 指定，默认5000
+     */
+    static int appCount();
+
+    /**
+     * 生成第index个模拟应用，相同的index总是生成相同的数据
+     */
+    static DataEntity app(int index);
+    static DataEntityVector apps(int count);
+    static DataEntityVector apps(int first, int count);
+
+    /**
+     * 重放应用安装，写入数据库后每burstSize个应用发送一次appDBItems2BAdd信号
+     */
+    static void replayAddStorm(const DataEntityVector &apps, int burstSize);
+
+    /**
+     * 重放应用数据更新，写入数据库后每burstSize个应用发送一次信号
+     * @param roles 变化的属性，不为空时发送带有变化属性的appDBItems2BUpdate，
+     * 为空时发送只有应用id的appDBItems2BUpdateAll，由数据库接口重新查询
+     */
+    static void replayUpdateStorm(const DataEntityVector &apps, const QVector<int> &roles, int burstSize);
+
+    /**
+     * 重放应用卸载，从数据库删除后每burstSize个应用发送一次appDBItems2BDelete信号
+     */
+    static void replayDeleteStorm(const QStringList &appIds, int burstSize);
+
+    /**
+     * 等待工作线程处理完已投递的数据库操作，以及界面线程处理完其发出的信号，
+     * 包括BasicAppModel在下一轮事件循环中的合并更新
+     */
+    static void waitForReplay();
+
+    /**
+     * 数据库接口发起的查询次数，每次查询为一次往返
+     */
+    static int queryCount();
+};
+
+} // LingmoMenu
+
+#endif //LINGMO_MENU_FAKE_APP_DATABASE_H
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "context-menu-manager.h"
+
+namespace LingmoMenu {
+
+// 测试程序不显示右键菜单，替代 src/extension/context-menu-manager.cpp 的实现
+ContextMenuManager *ContextMenuManager::instance()
+{
+    static ContextMenuManager manager;
+    return &manager;
+}
+
+ContextMenuManager::ContextMenuManager()
+{
+
+}
+
+ContextMenuManager::~ContextMenuManager() = default;
+
+void ContextMenuManager::showMenu(const QString &appid, MenuInfo::Location location, const QString &lid, const QPoint &point)
+{
+    Q_UNUSED(appid)
+    Q_UNUSED(location)
+    Q_UNUSED(lid)
+    Q_UNUSED(point)
+}
+
+void ContextMenuManager::showMenu(const DataEntity &data, MenuInfo::Location location, const QString &lid, const QPoint &point)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(location)
+    Q_UNUSED(lid)
+    Q_UNUSED(point)
+}
+
+void ContextMenuManager::setMainWindow(QWindow *mainWindow)
+{
+    Q_UNUSED(mainWindow)
+}
+
+bool ContextMenuManager::closeMenu()
+{
+    return false;
+}
+
+} // LingmoMenu
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "event-track.h"
+
+namespace LingmoMenu {
+
+// 测试程序不上报埋点数据，替代 src/utils/event-track.cpp 的实现
+EventTrack *EventTrack::qmlAttachedProperties(QObject *object)
+{
+    Q_UNUSED(object)
+    return instance();
+}
+
+EventTrack *EventTrack::instance()
+{
+    static EventTrack eventTrack;
+    return &eventTrack;
+}
+
+EventTrack::EventTrack(QObject *parent) : QObject(parent)
+{
+
+}
+
+void EventTrack::sendClickEvent(const QString &event, const QString &page, const QVariantMap &map)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(page)
+    Q_UNUSED(map)
+}
+
+void EventTrack::sendDefaultEvent(const QString &event, const QString &page, const QVariantMap &map)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(page)
+    Q_UNUSED(map)
+}
+
+void EventTrack::sendSearchEvent(const QString &event, const QString &page, const QString &content)
+{
+    Q_UNUSED(event)
+    Q_UNUSED(page)
+    Q_UNUSED(content)
+}
+
+} // LingmoMenu
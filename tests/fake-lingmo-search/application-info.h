@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINGMO_MENU_FAKE_APPLICATION_INFO_H
+#define LINGMO_MENU_FAKE_APPLICATION_INFO_H
+
+#include <QObject>
+#include <QMap>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+/**
+ * 测试用的应用数据库接口，只声明菜单用到的类型、函数和信号
+ * 基准测试使用此头文件代替 lingmo-search 的头文件，数据由 FakeAppDatabase 生成并保存在内存中
+ */
+namespace LingmoSearch {
+
+namespace ApplicationProperty {
+enum Property {
+    Invalid = 0,
+    DesktopFilePath,
+    InsertTime,
+    LocalName,
+    FirstLetterAll,
+    Icon,
+    Category,
+    LaunchTimes,
+    Favorites,
+    Launched,
+    Top,
+    Lock,
+    DontDisplay,
+    AutoStart
+};
+}
+
+typedef QVector<ApplicationProperty::Property> ApplicationProperties;
+typedef QMap<ApplicationProperty::Property, QVariant> ApplicationPropertyMap;
+typedef QMap<QString, ApplicationPropertyMap> ApplicationInfoMap;
+
+/**
+ * 与真实的数据库接口一样，每次查询都是一次往返，写入操作的结果通过appDBItems2BUpdate信号异步返回
+ */
+class ApplicationInfo : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ApplicationInfo(QObject *parent = nullptr);
+    ~ApplicationInfo() override;
+
+    ApplicationPropertyMap getInfo(const QString &desktopFile, ApplicationProperties properties);
+    ApplicationInfoMap getInfo(ApplicationProperties properties, ApplicationPropertyMap restrictions);
+
+    bool setAppToFavorites(const QString &desktopFilePath);
+    bool setFavoritesOfApp(const QString &desktopFilePath, size_t num);
+    bool setTopOfApp(const QString &desktopFilePath, size_t num);
+    bool setAppLaunchedState(const QString &desktopFilePath, bool launched = true);
+
+Q_SIGNALS:
+    void appDBItems2BUpdate(LingmoSearch::ApplicationInfoMap infoMap);
+    void appDBItems2BUpdateAll(QStringList desktopFilePaths);
+    void appDBItems2BAdd(QStringList desktopFilePaths);
+    void appDBItems2BDelete(QStringList desktopFilePaths);
+    void DBOpenFailed();
+
+private:
+    void setAppProperty(const QString &desktopFilePath, ApplicationProperty::Property property, const QVariant &value);
+};
+
+} // LingmoSearch
+
+#endif //LINGMO_MENU_FAKE_APPLICATION_INFO_H
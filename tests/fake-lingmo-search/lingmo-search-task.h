@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LINGMO_MENU_FAKE_LINGMO_SEARCH_TASK_H
+#define LINGMO_MENU_FAKE_LINGMO_SEARCH_TASK_H
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QQueue>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <atomic>
+#include <thread>
+
+/**
+ * 测试用的搜索接口，只声明菜单用到的类型、函数和信号
+ * 基准测试使用此头文件代替 lingmo-search 的头文件，不需要搜索服务
+ */
+namespace LingmoSearch {
+
+namespace SearchProperty {
+enum SearchType {
+    Application
+};
+
+enum SearchResultProperty {
+    ApplicationDesktopPath
+};
+}
+
+typedef QVector<SearchProperty::SearchResultProperty> SearchResultProperties;
+typedef QMap<SearchProperty::SearchResultProperty, QVariant> SearchResultPropertyMap;
+
+class ResultItem
+{
+public:
+    ResultItem() = default;
+    ResultItem(size_t searchId, const QString &itemKey, const SearchResultPropertyMap &map)
+        : m_searchId(searchId), m_itemKey(itemKey), m_map(map) {}
+
+    size_t getSearchId() const { return m_searchId; }
+    QString getItemKey() const { return m_itemKey; }
+    QVariant getValue(SearchProperty::SearchResultProperty property) const { return m_map.value(property); }
+    SearchResultPropertyMap getAllValue() const { return m_map; }
+
+private:
+    size_t m_searchId {0};
+    QString m_itemKey;
+    SearchResultPropertyMap m_map;
+};
+
+template <typename T>
+class DataQueue
+{
+public:
+    void enqueue(const T &item)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queue.enqueue(item);
+    }
+
+    // 队列为空时返回默认构造的数据
+    T tryDequeue()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_queue.isEmpty() ? T() : m_queue.dequeue();
+    }
+
+    bool isEmpty()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_queue.isEmpty();
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queue.clear();
+    }
+
+private:
+    QMutex m_mutex;
+    QQueue<T> m_queue;
+};
+
+/**
+ * 与搜索服务一样在独立的线程中搜索，结果逐个进入队列
+ * 搜索结束时发送searchFinished
+ * 模拟按应用关键字等本地索引中没有的内容匹配，任何关键字都返回目录中的前若干个应用
+ */
+class LingmoSearchTask : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LingmoSearchTask(QObject *parent = nullptr);
+    ~LingmoSearchTask() override;
+
+    DataQueue<ResultItem> *init();
+    void initSearchPlugin(SearchProperty::SearchType searchType, const QString &customSearchType = QString());
+    bool setResultProperties(SearchProperty::SearchType searchType, SearchResultProperties searchResultProperties);
+    void setSearchOnlineApps(bool searchOnlineApps);
+    void addKeyword(const QString &keyword);
+    void clearKeyWords();
+
+    size_t startSearch(SearchProperty::SearchType searchtype, QString customSearchType = QString());
+    void stop();
+
+Q_SIGNALS:
+    void searchFinished(size_t searchId);
+
+private:
+    void run(size_t searchId);
+
+private:
+    DataQueue<ResultItem> m_dataQueue;
+    QStringList m_keywords;
+    size_t m_searchId {0};
+    std::atomic<bool> m_stop {false};
+    std::thread m_thread;
+};
+
+} // LingmoSearch
+
+#endif //LINGMO_MENU_FAKE_LINGMO_SEARCH_TASK_H
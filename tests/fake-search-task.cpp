@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2024, LingmoSoft Co., Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "lingmo-search-task.h"
+#include "fake-app-database.h"
+
+// 每次搜索返回的结果数量
+#define FAKE_SEARCH_RESULT_COUNT 20
+
+namespace LingmoSearch {
+
+LingmoSearchTask::LingmoSearchTask(QObject *parent) : QObject(parent)
+{
+
+}
+
+LingmoSearchTask::~LingmoSearchTask()
+{
+    stop();
+}
+
+DataQueue<ResultItem> *LingmoSearchTask::init()
+{
+    return &m_dataQueue;
+}
+
+void LingmoSearchTask::initSearchPlugin(SearchProperty::SearchType searchType, const QString &customSearchType)
+{
+    Q_UNUSED(searchType)
+    Q_UNUSED(customSearchType)
+}
+
+bool LingmoSearchTask::setResultProperties(SearchProperty::SearchType searchType, SearchResultProperties searchResultProperties)
+{
+    Q_UNUSED(searchType)
+    Q_UNUSED(searchResultProperties)
+    return true;
+}
+
+void LingmoSearchTask::setSearchOnlineApps(bool searchOnlineApps)
+{
+    Q_UNUSED(searchOnlineApps)
+}
+
+void LingmoSearchTask::addKeyword(const QString &keyword)
+{
+    m_keywords.append(keyword);
+}
+
+void LingmoSearchTask::clearKeyWords()
+{
+    m_keywords.clear();
+}
+
+size_t LingmoSearchTask::startSearch(SearchProperty::SearchType searchtype, QString customSearchType)
+{
+    Q_UNUSED(searchtype)
+    Q_UNUSED(customSearchType)
+
+    // 与搜索服务一样，开始新的搜索时结束上一次搜索并清空队列
+    stop();
+    m_dataQueue.clear();
+
+    size_t searchId = ++m_searchId;
+    m_stop = false;
+    m_thread = std::thread(&LingmoSearchTask::run, this, searchId);
+    return searchId;
+}
+
+void LingmoSearchTask::stop()
+{
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void LingmoSearchTask::run(size_t searchId)
+{
+    const int count = qMin(FAKE_SEARCH_RESULT_COUNT, LingmoMenu::FakeAppDatabase::appCount());
+    for (int i = 0; i < count && !m_stop; ++i) {
+        SearchResultPropertyMap map;
+        map.insert(SearchProperty::ApplicationDesktopPath, LingmoMenu::FakeAppDatabase::app(i).id());
+        m_dataQueue.enqueue(ResultItem(searchId, map.value(SearchProperty::ApplicationDesktopPath).toString(), map));
+    }
+
+    if (!m_stop) {
+        Q_EMIT searchFinished(searchId);
+    }
+}
+
+} // LingmoSearch
@@ -307,6 +307,18 @@
         <source>Search</source>
         <translation>Suchen</translation>
     </message>
+    <message>
+        <source>Sort by relevance</source>
+        <translation>Nach Relevanz sortieren</translation>
+    </message>
+    <message>
+        <source>Sort by frequency</source>
+        <translation>Nach Häufigkeit sortieren</translation>
+    </message>
+    <message>
+        <source>Sort by name</source>
+        <translation>Nach Name sortieren</translation>
+    </message>
 </context>
 <context>
     <name>LingmoMenu::FavoriteExtension</name>
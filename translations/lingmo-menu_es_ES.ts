@@ -309,6 +309,18 @@
         <source>Search</source>
         <translation>Buscar</translation>
     </message>
+    <message>
+        <source>Sort by relevance</source>
+        <translation>Ordenar por relevancia</translation>
+    </message>
+    <message>
+        <source>Sort by frequency</source>
+        <translation>Ordenar por frecuencia</translation>
+    </message>
+    <message>
+        <source>Sort by name</source>
+        <translation>Ordenar por nombre</translation>
+    </message>
 </context>
 <context>
     <name>LingmoMenu::FavoriteExtension</name>
@@ -307,6 +307,18 @@
         <source>Search</source>
         <translation>Rechercher</translation>
     </message>
+    <message>
+        <source>Sort by relevance</source>
+        <translation>Trier par pertinence</translation>
+    </message>
+    <message>
+        <source>Sort by frequency</source>
+        <translation>Trier par fréquence</translation>
+    </message>
+    <message>
+        <source>Sort by name</source>
+        <translation>Trier par nom</translation>
+    </message>
 </context>
 <context>
     <name>LingmoMenu::FavoriteExtension</name>
@@ -307,6 +307,18 @@
         <source>Search</source>
         <translation>ٸزدەۋ</translation>
     </message>
+    <message>
+        <source>Sort by relevance</source>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>Sort by frequency</source>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>Sort by name</source>
+        <translation type="unfinished"></translation>
+    </message>
 </context>
 <context>
     <name>LingmoMenu::FavoriteExtension</name>
@@ -309,6 +309,18 @@
         <source>Search</source>
         <translation>ىزدۅۅ</translation>
     </message>
+    <message>
+        <source>Sort by relevance</source>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>Sort by frequency</source>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>Sort by name</source>
+        <translation type="unfinished"></translation>
+    </message>
 </context>
 <context>
     <name>LingmoMenu::FavoriteExtension</name>
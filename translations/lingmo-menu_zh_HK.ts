@@ -309,6 +309,18 @@
         <source>Search</source>
         <translation>搜索</translation>
     </message>
+    <message>
+        <source>Sort by relevance</source>
+        <translation>按相關度排序</translation>
+    </message>
+    <message>
+        <source>Sort by frequency</source>
+        <translation>按使用頻率排序</translation>
+    </message>
+    <message>
+        <source>Sort by name</source>
+        <translation>按名稱排序</translation>
+    </message>
 </context>
 <context>
     <name>LingmoMenu::FavoriteExtension</name>